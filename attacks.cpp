@@ -3,10 +3,69 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h>
+  #include <immintrin.h>
+  #define CHESSY_HAS_PEXT 1
+  #define CHESSY_TARGET_BMI2
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  #include <cpuid.h>
+  #include <immintrin.h>
+  #define CHESSY_HAS_PEXT 1
+  #define CHESSY_TARGET_BMI2 __attribute__((target("bmi2")))
+#else
+  #define CHESSY_HAS_PEXT 0
+#endif
+
+static constexpr bool on_board(int f, int r) { return f >= 0 && f < 8 && r >= 0 && r < 8; }
 
-Attacks ATK;
+// ----------------------------
+// Leaper + between/line tables (compile time)
+// ----------------------------
+static constexpr Attacks build_static_tables() {
+  Attacks a{};
+  constexpr int dfN[8] = {-2, -2, -1, -1, 1, 1, 2, 2};
+  constexpr int drN[8] = {-1, 1, -2, 2, -2, 2, -1, 1};
+  constexpr int dfK[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+  constexpr int drK[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+
+  for (int sq = 0; sq < 64; sq++) {
+    const int f = file_of(sq), r = rank_of(sq);
+
+    if (on_board(f - 1, r + 1)) a.pawn[WHITE][sq] |= sq_bb((r + 1) * 8 + (f - 1));
+    if (on_board(f + 1, r + 1)) a.pawn[WHITE][sq] |= sq_bb((r + 1) * 8 + (f + 1));
+    if (on_board(f - 1, r - 1)) a.pawn[BLACK][sq] |= sq_bb((r - 1) * 8 + (f - 1));
+    if (on_board(f + 1, r - 1)) a.pawn[BLACK][sq] |= sq_bb((r - 1) * 8 + (f + 1));
 
-static inline bool on_board(int f, int r) { return f >= 0 && f < 8 && r >= 0 && r < 8; }
+    for (int i = 0; i < 8; i++) {
+      if (on_board(f + dfN[i], r + drN[i])) a.knight[sq] |= sq_bb((r + drN[i]) * 8 + f + dfN[i]);
+      if (on_board(f + dfK[i], r + drK[i])) a.king[sq] |= sq_bb((r + drK[i]) * 8 + f + dfK[i]);
+    }
+
+    // Walk each of the 8 rays once: every square on the ray shares the same full line,
+    // and the squares already passed are exactly the ones in between.
+    for (int i = 0; i < 8; i++) {
+      const int df = dfK[i], dr = drK[i];
+      U64 full = sq_bb(sq);
+      for (int k = 1; on_board(f + k * df, r + k * dr); k++) full |= sq_bb((r + k * dr) * 8 + f + k * df);
+      for (int k = 1; on_board(f - k * df, r - k * dr); k++) full |= sq_bb((r - k * dr) * 8 + f - k * df);
+
+      U64 passed = 0;
+      for (int k = 1; on_board(f + k * df, r + k * dr); k++) {
+        const int to = (r + k * dr) * 8 + f + k * df;
+        a.between[sq][to] = passed;
+        a.line[sq][to] = full;
+        passed |= sq_bb(to);
+      }
+    }
+  }
+  return a;
+}
+
+// Constant-initialised: lands in the data segment, nothing to compute at startup.
+Attacks ATK = build_static_tables();
 
 // ----------------------------
 // Sliding attacks via magics
@@ -14,8 +73,8 @@ static inline bool on_board(int f, int r) { return f >= 0 && f < 8 && r >= 0 &&
 namespace {
 
 // Magic constants (a1 = 0, little-endian file/rank mapping).
-// These are commonly used "good" multipliers; we still validate
-// them at startup and will search for a replacement if any collisions occur.
+// All 128 are known collision-free for the dense (fancy) layout below, so startup only
+// fills the table; a square whose magic ever failed would fall back to slow attacks.
 static constexpr std::array<U64, 64> ROOK_MAGICS = {
     0x0a8002c000108020ULL,
     0x006c00049b0002001ULL,
@@ -41,9 +100,9 @@ static constexpr std::array<U64, 64> ROOK_MAGICS = {
     0x8000808004000200ULL,
     0x0201008080010200ULL,
     0x0801020000441091ULL,
-    0x0008000802040005ULL,
+    0x01c0400080033180ULL,
     0x1040200040100048ULL,
-    0x0001202004020082ULL,
+    0x0040200080100082ULL,
     0x0d14880480100080ULL,
     0x12040280080080ULL,
     0x0100040080020080ULL,
@@ -66,10 +125,10 @@ static constexpr std::array<U64, 64> ROOK_MAGICS = {
     0x1000100200040208ULL,
     0x430000a044020001ULL,
     0x0280009023410300ULL,
-    0x0e01000400002240ULL,
+    0x0010220d00804200ULL,
     0x000200100401700ULL,
     0x2244100408008080ULL,
-    0x00080000400801980ULL,
+    0x0002480011004500ULL,
     0x0002000810040200ULL,
     0x8010100228810400ULL,
     0x2000009044210200ULL,
@@ -93,7 +152,7 @@ static constexpr std::array<U64, 64> BISHOP_MAGICS = {
     0x0020a02a2400084ULL,
     0x0440404400a01000ULL,
     0x0008931041080080ULL,
-    0x0002004841080221ULL,
+    0x0814089001004101ULL,
     0x0080460802188000ULL,
     0x4000090401080092ULL,
     0x4000011040a00004ULL,
@@ -157,9 +216,15 @@ static U64 bishop_magic[64];
 static int rook_shift[64];
 static int bishop_shift[64];
 
-// Max table sizes: rook <= 2^12, bishop <= 2^9
-static U64 rook_table[64][4096];
-static U64 bishop_table[64][512];
+// "Fancy" magics: every square owns exactly 2^bits entries at its own offset in one
+// packed table (rook 102400 + bishop 5248 entries, ~840 KB) instead of padding each
+// square to the worst case (64*4096 + 64*512, ~2.3 MB). Dense PEXT indexing needs the
+// same per-square sizes, so both backends share this table; only the fill order differs.
+static constexpr int ROOK_TABLE_SIZE = 102400;
+static constexpr int BISHOP_TABLE_SIZE = 5248;
+alignas(64) static U64 slider_table[ROOK_TABLE_SIZE + BISHOP_TABLE_SIZE];
+static U64* rook_table[64];
+static U64* bishop_table[64];
 
 static bool magics_ready = false;
 
@@ -235,20 +300,6 @@ static U64 bishop_relevant_mask(int sq) {
   return m;
 }
 
-static inline U64 splitmix64(U64& x) {
-  x += 0x9e3779b97f4a7c15ULL;
-  U64 z = x;
-  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
-  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
-  return z ^ (z >> 31);
-}
-
-static inline U64 random_u64(U64& s) { return splitmix64(s); }
-
-static inline U64 random_u64_fewbits(U64& s) {
-  return random_u64(s) & random_u64(s) & random_u64(s);
-}
-
 static bool build_table_for_square(bool rook, int sq, U64 magic) {
   const U64 mask = rook ? rook_mask[sq] : bishop_mask[sq];
   const int shift = rook ? rook_shift[sq] : bishop_shift[sq];
@@ -279,7 +330,7 @@ static bool build_table_for_square(bool rook, int sq, U64 magic) {
       local[key] = att;
     }
 
-    // Copy into global
+    // Copy into the packed table
     for (int i = 0; i < size; i++) rook_table[sq][i] = local[i];
     return true;
   } else {
@@ -303,161 +354,158 @@ static bool build_table_for_square(bool rook, int sq, U64 magic) {
   }
 }
 
-static U64 find_magic_for_square(bool rook, int sq, U64 seed) {
-  const U64 mask = rook ? rook_mask[sq] : bishop_mask[sq];
-  const int shift = rook ? rook_shift[sq] : bishop_shift[sq];
-  const int bits = 64 - shift;
-  const int size = 1 << bits;
-
-  // Precompute occupancies + attacks
-  std::array<int, 12> squares{};
-  int n = 0;
-  U64 tmp = mask;
-  while (tmp) squares[n++] = pop_lsb(tmp);
-
-  std::array<U64, 4096> occs{};
-  std::array<U64, 4096> atts{};
-  for (int idx = 0; idx < size; idx++) {
-    U64 occ = 0;
-    for (int b = 0; b < n; b++) {
-      if (idx & (1 << b)) occ |= sq_bb(squares[b]);
-    }
-    occs[idx] = occ;
-    atts[idx] = rook ? rook_attacks_slow(sq, occ) : bishop_attacks_slow(sq, occ);
-  }
-
-  U64 state = seed ^ (U64)sq * 0x9e3779b97f4a7c15ULL;
-
-  // Try random candidates until we find a collision-free mapping.
-  // This is startup-only.
-  for (int iter = 0; iter < 500000; iter++) {
-    U64 magic = random_u64_fewbits(state);
-
-    // Quick heuristic from chessprogramming: reject magics that don't spread high bits well.
-    if (popcount64((mask * magic) & 0xFF00000000000000ULL) < 6) continue;
-
-    if (rook) {
-      std::array<U64, 4096> used{};
-      std::array<uint8_t, 4096> filled{};
-
-      bool ok = true;
-      for (int i = 0; i < size; i++) {
-        U64 key = (occs[i] * magic) >> shift;
-        if (filled[key] && used[key] != atts[i]) { ok = false; break; }
-        filled[key] = 1;
-        used[key] = atts[i];
-      }
-      if (ok) return magic;
-    } else {
-      std::array<U64, 512> used{};
-      std::array<uint8_t, 512> filled{};
-
-      bool ok = true;
-      for (int i = 0; i < size; i++) {
-        U64 key = (occs[i] * magic) >> shift;
-        if (filled[key] && used[key] != atts[i]) { ok = false; break; }
-        filled[key] = 1;
-        used[key] = atts[i];
-      }
-      if (ok) return magic;
-    }
-  }
-
-  // Fallback (very unlikely): return the provided magic even if it collides,
-  // but then we'll skip magics and use slow attacks at runtime for that square.
-  return 0ULL;
-}
-
 static void init_magics() {
   if (magics_ready) return;
 
   // Masks + shifts based on the standard relevant-occupancy definition.
+  U64* next = slider_table;
   for (int sq = 0; sq < 64; sq++) {
     rook_mask[sq] = rook_relevant_mask(sq);
-    bishop_mask[sq] = bishop_relevant_mask(sq);
-
     int rb = popcount64(rook_mask[sq]);
-    int bb = popcount64(bishop_mask[sq]);
-
     rook_shift[sq] = 64 - rb;
+    rook_table[sq] = next;
+    next += (size_t)1 << rb;
+  }
+  for (int sq = 0; sq < 64; sq++) {
+    bishop_mask[sq] = bishop_relevant_mask(sq);
+    int bb = popcount64(bishop_mask[sq]);
     bishop_shift[sq] = 64 - bb;
+    bishop_table[sq] = next;
+    next += (size_t)1 << bb;
+  }
 
+  for (int sq = 0; sq < 64; sq++) {
     rook_magic[sq] = ROOK_MAGICS[sq];
     bishop_magic[sq] = BISHOP_MAGICS[sq];
   }
 
-  // Build rook + bishop tables.
-  // Validate provided magics; if any fails, search for a replacement at startup.
+  magics_ready = true;
+}
+
+// Fill the shared table in magic index order. Building a square doubles as validating
+// its magic; a colliding one is zeroed so lookups for that square use slow attacks.
+static void fill_magic_tables() {
   for (int sq = 0; sq < 64; sq++) {
-    if (!build_table_for_square(true, sq, rook_magic[sq])) {
-      U64 m = find_magic_for_square(true, sq, 0xC0FFEE123456789ULL);
-      if (m) {
-        rook_magic[sq] = m;
-        (void)build_table_for_square(true, sq, rook_magic[sq]);
-      } else {
-        // Mark as unusable; rook_attacks will fall back to slow.
-        rook_magic[sq] = 0ULL;
-      }
-    }
+    if (rook_magic[sq] && !build_table_for_square(true, sq, rook_magic[sq])) rook_magic[sq] = 0ULL;
+    if (bishop_magic[sq] && !build_table_for_square(false, sq, bishop_magic[sq])) bishop_magic[sq] = 0ULL;
+  }
+}
 
-    if (!build_table_for_square(false, sq, bishop_magic[sq])) {
-      U64 m = find_magic_for_square(false, sq, 0xBADF00DCAFEBEEFULL);
-      if (m) {
-        bishop_magic[sq] = m;
-        (void)build_table_for_square(false, sq, bishop_magic[sq]);
-      } else {
-        bishop_magic[sq] = 0ULL;
-      }
-    }
+// ----------------------------
+// Sliding attacks via BMI2 PEXT
+// ----------------------------
+// PEXT compresses the relevant occupancy bits into a dense index, so no multiplier is
+// needed. Same per-square slices of slider_table as the magics, filled in PEXT order.
+static SliderBackend backend = SLIDER_MAGIC;
+
+static void fill_pext_tables() {
+  for (int sq = 0; sq < 64; sq++) {
+    // Carry-rippler enumerates the subsets of a mask in PEXT index order.
+    U64* r = rook_table[sq];
+    U64 occ = 0;
+    do { *r++ = rook_attacks_slow(sq, occ); occ = (occ - rook_mask[sq]) & rook_mask[sq]; } while (occ);
+
+    U64* b = bishop_table[sq];
+    occ = 0;
+    do { *b++ = bishop_attacks_slow(sq, occ); occ = (occ - bishop_mask[sq]) & bishop_mask[sq]; } while (occ);
   }
+}
 
-  magics_ready = true;
+// PEXT is microcoded (hundreds of cycles) on AMD before Zen 3, so only trust it on
+// Intel (Haswell+) and AMD family 19h or newer.
+static bool cpu_has_fast_pext() {
+#if CHESSY_HAS_PEXT
+  unsigned a = 0, b = 0, c = 0, d = 0;
+  char vendor[13] = {};
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  a = (unsigned)info[0];
+  std::memcpy(vendor + 0, &info[1], 4);
+  std::memcpy(vendor + 4, &info[3], 4);
+  std::memcpy(vendor + 8, &info[2], 4);
+  if (a < 7) return false;
+  __cpuidex(info, 7, 0);
+  bool bmi2 = (info[1] & (1 << 8)) != 0;
+  __cpuid(info, 1);
+  a = (unsigned)info[0];
+#else
+  if (!__get_cpuid(0, &a, &b, &c, &d) || a < 7) return false;
+  std::memcpy(vendor + 0, &b, 4);
+  std::memcpy(vendor + 4, &d, 4);
+  std::memcpy(vendor + 8, &c, 4);
+  __cpuid_count(7, 0, a, b, c, d);
+  bool bmi2 = (b & (1u << 8)) != 0;
+  __get_cpuid(1, &a, &b, &c, &d);
+#endif
+  if (!bmi2) return false;
+  if (std::strcmp(vendor, "AuthenticAMD") == 0) {
+    unsigned family = ((a >> 8) & 0xF) + ((a >> 20) & 0xFF);
+    return family >= 0x19;
+  }
+  return true;
+#else
+  return false;
+#endif
 }
 
+#if CHESSY_HAS_PEXT
+CHESSY_TARGET_BMI2 static U64 rook_attacks_pext(int sq, U64 occ) {
+  return rook_table[sq][_pext_u64(occ, rook_mask[sq])];
+}
+
+CHESSY_TARGET_BMI2 static U64 bishop_attacks_pext(int sq, U64 occ) {
+  return bishop_table[sq][_pext_u64(occ, bishop_mask[sq])];
+}
+#endif
+
 } // namespace
 
 void Attacks::init() {
-  for (int sq = 0; sq < 64; sq++) {
-    int f = file_of(sq), r = rank_of(sq);
+  init_magics();
 
-    pawn[WHITE][sq] = 0;
-    pawn[BLACK][sq] = 0;
+  // Fill the shared slider table once, in the order the chosen backend indexes it.
+  if (CHESSY_HAS_PEXT && cpu_has_fast_pext()) {
+    fill_pext_tables();
+    backend = SLIDER_PEXT;
+  } else {
+    fill_magic_tables();
+    backend = SLIDER_MAGIC;
+  }
+}
 
-    if (on_board(f - 1, r + 1)) pawn[WHITE][sq] |= sq_bb((r + 1) * 8 + (f - 1));
-    if (on_board(f + 1, r + 1)) pawn[WHITE][sq] |= sq_bb((r + 1) * 8 + (f + 1));
-    if (on_board(f - 1, r - 1)) pawn[BLACK][sq] |= sq_bb((r - 1) * 8 + (f - 1));
-    if (on_board(f + 1, r - 1)) pawn[BLACK][sq] |= sq_bb((r - 1) * 8 + (f + 1));
+SliderBackend slider_backend() { return backend; }
 
-    const int dfN[8] = {-2, -2, -1, -1, 1, 1, 2, 2};
-    const int drN[8] = {-1, 1, -2, 2, -2, 2, -1, 1};
-    U64 k = 0;
-    for (int i = 0; i < 8; i++) {
-      int nf = f + dfN[i], nr = r + drN[i];
-      if (on_board(nf, nr)) k |= sq_bb(nr * 8 + nf);
-    }
-    knight[sq] = k;
-
-    U64 g = 0;
-    for (int df = -1; df <= 1; df++) {
-      for (int dr = -1; dr <= 1; dr++) {
-        if (df == 0 && dr == 0) continue;
-        int nf = f + df, nr = r + dr;
-        if (on_board(nf, nr)) g |= sq_bb(nr * 8 + nf);
-      }
-    }
-    king[sq] = g;
+// Refills the shared table, so never call this while a search is running.
+bool set_slider_backend(SliderBackend b) {
+  if (b == backend) return true;
+  if (b == SLIDER_PEXT) {
+    if (!(CHESSY_HAS_PEXT && cpu_has_fast_pext())) return false;
+    fill_pext_tables();
+  } else {
+    fill_magic_tables();
   }
+  backend = b;
+  return true;
+}
 
-  init_magics();
+const char* slider_backend_name(SliderBackend b) {
+  return b == SLIDER_PEXT ? "pext" : "magic";
 }
 
 U64 rook_attacks(int sq, U64 occ) {
+#if CHESSY_HAS_PEXT
+  if (backend == SLIDER_PEXT) return rook_attacks_pext(sq, occ);
+#endif
   if (!magics_ready || rook_magic[sq] == 0ULL) return rook_attacks_slow(sq, occ);
   U64 x = (occ & rook_mask[sq]) * rook_magic[sq];
   return rook_table[sq][x >> rook_shift[sq]];
 }
 
 U64 bishop_attacks(int sq, U64 occ) {
+#if CHESSY_HAS_PEXT
+  if (backend == SLIDER_PEXT) return bishop_attacks_pext(sq, occ);
+#endif
   if (!magics_ready || bishop_magic[sq] == 0ULL) return bishop_attacks_slow(sq, occ);
   U64 x = (occ & bishop_mask[sq]) * bishop_magic[sq];
   return bishop_table[sq][x >> bishop_shift[sq]];
@@ -6,6 +6,13 @@ struct Attacks {
   U64 knight[64]{};
   U64 king[64]{};
 
+  // Squares strictly between two aligned squares (0 if not on a common rank/file/diagonal).
+  U64 between[64][64]{};
+  // Full board line through two aligned squares, endpoints included (0 if not aligned).
+  U64 line[64][64]{};
+
+  // Leaper and between/line tables above are compile-time constants (see attacks.cpp);
+  // init() only fills the slider attack table for the selected backend.
   void init();
 };
 
@@ -13,3 +20,12 @@ extern Attacks ATK;
 
 U64 rook_attacks(int sq, U64 occ);
 U64 bishop_attacks(int sq, U64 occ);
+
+// Slider attack backend: BMI2 PEXT-indexed tables when the CPU has fast PEXT
+// (picked in Attacks::init via CPUID), magic multiplication otherwise.
+enum SliderBackend : int { SLIDER_MAGIC = 0, SLIDER_PEXT = 1 };
+
+SliderBackend slider_backend();
+// Returns false (and keeps the current backend) if PEXT is unavailable on this CPU/build.
+bool set_slider_backend(SliderBackend b);
+const char* slider_backend_name(SliderBackend b);
@@ -0,0 +1,203 @@
+#include "bench.h"
+#include "attacks.h"
+#include "eval.h"
+#include "fen.h"
+#include "nnue.h"
+#include "perft.h"
+#include "search.h"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static const char* BENCH_FENS[] = {
+  "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+  "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+  "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+  "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+using BenchClock = std::chrono::steady_clock;
+
+static double seconds_since(BenchClock::time_point t0) {
+  return std::chrono::duration<double>(BenchClock::now() - t0).count();
+}
+
+// Evaluate every node of a shallow tree (no eval cache, so every call hits the sliders).
+static uint64_t eval_tree(Position& pos, int depth, int64_t& sink) {
+  sink += eval_uncached(pos);
+  if (depth == 0) return 1;
+  MoveList ml;
+  pos.gen_legal(ml);
+  uint64_t n = 1;
+  for (int i = 0; i < ml.size; i++) {
+    Undo u;
+    pos.make(ml.moves[i], u);
+    n += eval_tree(pos, depth - 1, sink);
+    pos.unmake(ml.moves[i], u);
+  }
+  return n;
+}
+
+static void run_backend(SliderBackend b, const std::vector<Position>& positions) {
+  const char* name = slider_backend_name(b);
+
+  // Raw lookups over pseudo-random occupancies.
+  {
+    uint64_t x = 0x9e3779b97f4a7c15ULL, acc = 0;
+    const int N = 20'000'000;
+    auto t0 = BenchClock::now();
+    for (int i = 0; i < N; i++) {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+      int sq = (int)(x & 63);
+      U64 occ = x & (x >> 11);
+      acc += rook_attacks(sq, occ) ^ bishop_attacks(sq, occ);
+    }
+    double s = seconds_since(t0);
+    std::cout << "info string bench " << name << " lookups " << (2.0 * N / s / 1e6)
+              << " M/s (chk " << (acc & 0xFFFF) << ")" << std::endl;
+  }
+
+  // Movegen: perft.
+  {
+    uint64_t nodes = 0;
+    auto t0 = BenchClock::now();
+    for (const auto& p : positions) {
+      Position tmp = p;
+      nodes += perft(tmp, 4);
+    }
+    double s = seconds_since(t0);
+    std::cout << "info string bench " << name << " perft nodes " << nodes
+              << " time " << (int)(s * 1000) << " ms nps " << (uint64_t)(nodes / s) << std::endl;
+  }
+
+  // Eval: uncached static eval over a depth-3 tree.
+  {
+    uint64_t nodes = 0;
+    int64_t sink = 0;
+    auto t0 = BenchClock::now();
+    nnue::AccStack st; // incremental updates, as in a search
+    for (const auto& p : positions) {
+      Position tmp = p;
+      if (nnue::enabled()) nnue::attach(tmp, &st);
+      nodes += eval_tree(tmp, 3, sink);
+    }
+    double s = seconds_since(t0);
+    std::cout << "info string bench " << name << " evals " << nodes
+              << " time " << (int)(s * 1000) << " ms evals/s " << (uint64_t)(nodes / s)
+              << " (chk " << (sink & 0xFFFF) << ")" << std::endl;
+  }
+}
+
+void bench_slider_backends() {
+  std::vector<Position> positions;
+  for (const char* fen : BENCH_FENS) {
+    Position p;
+    if (load_fen(p, fen)) positions.push_back(p);
+  }
+
+  const SliderBackend startup = slider_backend();
+  std::cout << "info string bench startup backend " << slider_backend_name(startup) << std::endl;
+
+  (void)set_slider_backend(SLIDER_MAGIC);  // magic is always available
+  run_backend(SLIDER_MAGIC, positions);
+
+  if (set_slider_backend(SLIDER_PEXT)) run_backend(SLIDER_PEXT, positions);
+  else std::cout << "info string bench pext unavailable on this cpu/build" << std::endl;
+
+  (void)set_slider_backend(startup);
+}
+
+void bench_smp(int threads, int depth) {
+  const std::pair<SmpMode, const char*> modes[] = {
+    {SMP_ROOT_SPLIT, "rootsplit"}, {SMP_LAZY, "lazysmp"}, {SMP_ABDADA, "abdada"},
+  };
+
+  for (const auto& [mode, name] : modes) {
+    double totalMs = 0;
+    for (const char* fen : BENCH_FENS) {
+      Position pos;
+      if (!load_fen(pos, fen)) continue;
+
+      auto searcher = std::make_unique<Searcher>();
+      searcher->useBook = false;
+      searcher->tt_resize_mb(64);
+      searcher->set_threads(threads);
+      searcher->smpMode = mode;
+      searcher->tt.allocate(); // otherwise go() allocates it inside the timed region
+
+      GoLimits lim{};
+      lim.depth = depth;
+      auto t0 = BenchClock::now();
+      (void)searcher->go(pos, lim);
+      totalMs += seconds_since(t0) * 1000.0;
+    }
+    std::cout << "info string bench smp " << name << " threads " << threads << " depth " << depth
+              << " time " << (int)totalMs << " ms" << std::endl;
+  }
+}
+
+// Uncached evals/s over a depth-3 tree, then nodes/s of a fixed-depth search per position.
+static void run_evaluator(const std::string& name, const std::vector<Position>& positions, int depth) {
+  eval_cache_clear();
+  {
+    uint64_t nodes = 0;
+    int64_t sink = 0;
+    auto t0 = BenchClock::now();
+    nnue::AccStack st; // incremental updates, as in a search
+    for (const auto& p : positions) {
+      Position tmp = p;
+      if (nnue::enabled()) nnue::attach(tmp, &st);
+      nodes += eval_tree(tmp, 3, sink);
+    }
+    double s = seconds_since(t0);
+    std::cout << "info string bench " << name << " evals " << nodes
+              << " time " << (int)(s * 1000) << " ms evals/s " << (uint64_t)(nodes / s)
+              << " (chk " << (sink & 0xFFFF) << ")" << std::endl;
+  }
+  {
+    uint64_t nodes = 0;
+    double s = 0;
+    for (const auto& p : positions) {
+      Position pos = p;
+      auto searcher = std::make_unique<Searcher>();
+      searcher->useBook = false;
+      searcher->tt_resize_mb(64);
+      searcher->tt.allocate(); // otherwise go() allocates it inside the timed region
+
+      GoLimits lim{};
+      lim.depth = depth;
+      auto t0 = BenchClock::now();
+      (void)searcher->go(pos, lim);
+      s += seconds_since(t0);
+      nodes += searcher->totals().nodes;
+    }
+    std::cout << "info string bench " << name << " search depth " << depth << " nodes " << nodes
+              << " time " << (int)(s * 1000) << " ms nps " << (uint64_t)(nodes / s) << std::endl;
+  }
+}
+
+void bench_nnue(const std::string& evalFile, int depth) {
+  std::vector<Position> positions;
+  for (const char* fen : BENCH_FENS) {
+    Position p;
+    if (load_fen(p, fen)) positions.push_back(p);
+  }
+
+  nnue::unload();
+  run_evaluator("classical", positions, depth);
+
+  if (!nnue::load(evalFile)) {
+    std::cout << "info string bench nnue failed to load " << evalFile << std::endl;
+    return;
+  }
+  const nnue::SimdBackend startup = nnue::simd_backend();
+  for (nnue::SimdBackend b : {nnue::SIMD_SCALAR, nnue::SIMD_SSE41, nnue::SIMD_AVX2}) {
+    const std::string name = std::string("nnue-") + nnue::simd_backend_name(b);
+    if (nnue::set_simd_backend(b)) run_evaluator(name, positions, depth);
+    else std::cout << "info string bench " << name << " unavailable on this cpu/build" << std::endl;
+  }
+  (void)nnue::set_simd_backend(startup);
+}
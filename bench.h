@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+
+// Microbenchmark for the slider attack backends (magic vs PEXT).
+// Runs a raw lookup loop, a perft movegen workload and an uncached eval workload
+// with each available backend and prints timings. Restores the startup backend.
+void bench_slider_backends();
+
+// Time-to-depth comparison of the SMP modes (root split, Lazy SMP, ABDADA): a fixed-depth
+// search of each bench position per mode, with a fresh searcher (cold TT) every time.
+void bench_smp(int threads, int depth);
+
+// Classical eval vs NNUE with each available SIMD backend: uncached evals/s and
+// fixed-depth search nps over the bench positions. Leaves the network loaded.
+void bench_nnue(const std::string& evalFile, int depth);
@@ -7,8 +7,8 @@
 #endif
 
 inline constexpr U64 sq_bb(int sq) { return 1ULL << sq; }
-inline int file_of(int sq) { return sq & 7; }
-inline int rank_of(int sq) { return sq >> 3; }
+inline constexpr int file_of(int sq) { return sq & 7; }
+inline constexpr int rank_of(int sq) { return sq >> 3; }
 
 inline int ctz64(U64 x) {
 #if defined(_MSC_VER)
@@ -1,6 +1,8 @@
 #include "cli.h"
 #include "fen.h"
 #include "search.h"
+#include "perft.h"
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -35,16 +37,8 @@ static void print_board(const Position& pos) {
 
 static bool has_any_legal_move(Position& pos) {
   MoveList ml;
-  pos.gen_pseudo(ml);
-  for (int i=0;i<ml.size;i++){
-    Undo u;
-    Color us = pos.stm;
-    pos.make(ml.moves[i], u);
-    bool ok = !pos.is_attacked(pos.kingSq[us], pos.stm);
-    pos.unmake(ml.moves[i], u);
-    if (ok) return true;
-  }
-  return false;
+  pos.gen_legal(ml);
+  return ml.size > 0;
 }
 
 void cli_loop(Position& pos) {
@@ -55,7 +49,7 @@ void cli_loop(Position& pos) {
   load_fen(pos, startpos);
 
   std::cout << "Chessy CLI mode\n";
-  std::cout << "Commands: d | new | fen <...> | move <e2e4> | go <ms> | auto <ms> | quit\n";
+  std::cout << "Commands: d | new | fen <...> | move <e2e4> | go <ms> | auto <ms> | perft <n> | divide <n> | perftsuite <epd> [n] | quit\n";
   print_board(pos);
 
   std::string line;
@@ -149,8 +143,27 @@ void cli_loop(Position& pos) {
         pos.make(best, u);
         print_board(pos);
       }
+    } else if (cmd == "perft" || cmd == "divide") {
+      int depth = 0;
+      iss >> depth;
+      if (depth <= 0) { std::cout << "Usage: " << cmd << " <depth>\n"; continue; }
+      if (cmd == "divide") {
+        perft_divide(pos, depth, searcher->threads, 64, std::cout);
+      } else {
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint64_t n = perft_root_mt(pos, depth, searcher->threads, 64);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << "perft " << depth << ": " << n << " (" << (uint64_t)ms << " ms, "
+                  << (uint64_t)(ms > 0 ? n * 1000.0 / ms : 0) << " nps)\n";
+      }
+    } else if (cmd == "perftsuite") {
+      std::string file;
+      int maxDepth = 6;
+      iss >> file >> maxDepth;
+      if (file.empty()) { std::cout << "Usage: perftsuite <file.epd> [maxDepth]\n"; continue; }
+      perft_suite(file, maxDepth, searcher->threads, 0, std::cout);
     } else {
-      std::cout << "Unknown command. Try: d, new, fen, move, go, auto, quit\n";
+      std::cout << "Unknown command. Try: d, new, fen, move, go, auto, perft, divide, perftsuite, quit\n";
     }
   }
 }
\ No newline at end of file
@@ -1,17 +1,20 @@
 #include "eval.h"
 #include "params.h"
+#include "psqt.h"
+#include "nnue.h"
 #include "attacks.h"
 #include "bitboard.h"
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 // Queen = rook | bishop
 static inline U64 queen_attacks(int sq, U64 occ) {
   return rook_attacks(sq, occ) | bishop_attacks(sq, occ);
 }
 
-static inline int mirror_sq(int sq) { return sq ^ 56; } // flip ranks for black PST indexing
-
 // ------------------------------------------------------------
 // Tunable weights
 // ------------------------------------------------------------
@@ -73,183 +76,21 @@ static constexpr int BAD_BISHOP_PEN_EG = 4;
 static constexpr int PASSED_MG[8] = {0,  5, 10, 20, 35, 55, 85, 0};
 static constexpr int PASSED_EG[8] = {0, 10, 20, 35, 55, 85,120, 0};
 
-// Tapered material values
-static constexpr int MG_VAL[6] = { 82, 337, 365, 477, 1025, 0 };
-static constexpr int EG_VAL[6] = { 94, 281, 297, 512,  936, 0 };
-
-// Phase increments (how much each piece contributes to "middlegame-ness")
-static constexpr int PHASE_INC[6] = {0, 1, 1, 2, 4, 0};
-static constexpr int TOTAL_PHASE = 24;
-
 // ------------------------------------------------------------
-// PSTs
+// Masks and helpers
 // ------------------------------------------------------------
-static constexpr int PST_P_MG[64] = {
-   0,  0,  0,  0,  0,  0,  0,  0,
-  10, 12,  6, -5, -5,  6, 12, 10,
-   4,  4,  2,  8,  8,  2,  4,  4,
-   2,  2,  6, 14, 14,  6,  2,  2,
-   2,  4,  8, 18, 18,  8,  4,  2,
-   4,  6, 10,  0,  0, 10,  6,  4,
-  40, 40, 40, 40, 40, 40, 40, 40,
-   0,  0,  0,  0,  0,  0,  0,  0
-};
-
-static constexpr int PST_P_EG[64] = {
-   0,  0,  0,  0,  0,  0,  0,  0,
-  20, 18, 16, 14, 14, 16, 18, 20,
-  12, 12, 12, 12, 12, 12, 12, 12,
-   8, 10, 12, 14, 14, 12, 10,  8,
-   6,  8, 10, 12, 12, 10,  8,  6,
-   4,  6,  8, 10, 10,  8,  6,  4,
-   2,  2,  2,  2,  2,  2,  2,  2,
-   0,  0,  0,  0,  0,  0,  0,  0
-};
-
-static constexpr int PST_N_MG[64] = {
- -50,-40,-30,-30,-30,-30,-40,-50,
- -40,-20,  0,  0,  0,  0,-20,-40,
- -30,  0, 10, 15, 15, 10,  0,-30,
- -30,  5, 15, 20, 20, 15,  5,-30,
- -30,  0, 15, 20, 20, 15,  0,-30,
- -30,  5, 10, 15, 15, 10,  5,-30,
- -40,-20,  0,  5,  5,  0,-20,-40,
- -50,-40,-30,-30,-30,-30,-40,-50
+static constexpr U64 FILE_A = 0x0101010101010101ULL;
+static constexpr U64 FILE_MASK[8] = {
+  FILE_A << 0, FILE_A << 1, FILE_A << 2, FILE_A << 3,
+  FILE_A << 4, FILE_A << 5, FILE_A << 6, FILE_A << 7,
 };
-
-static constexpr int PST_N_EG[64] = {
- -40,-30,-20,-20,-20,-20,-30,-40,
- -30,-10,  0,  0,  0,  0,-10,-30,
- -20,  0, 10, 12, 12, 10,  0,-20,
- -20,  5, 12, 18, 18, 12,  5,-20,
- -20,  0, 12, 18, 18, 12,  0,-20,
- -20,  5, 10, 12, 12, 10,  5,-20,
- -30,-10,  0,  5,  5,  0,-10,-30,
- -40,-30,-20,-20,-20,-20,-30,-40
-};
-
-static constexpr int PST_B_MG[64] = {
- -20,-10,-10,-10,-10,-10,-10,-20,
- -10,  0,  0,  0,  0,  0,  0,-10,
- -10,  0,  5, 10, 10,  5,  0,-10,
- -10,  5,  5, 10, 10,  5,  5,-10,
- -10,  0, 10, 10, 10, 10,  0,-10,
- -10, 10, 10, 10, 10, 10, 10,-10,
- -10,  5,  0,  0,  0,  0,  5,-10,
- -20,-10,-10,-10,-10,-10,-10,-20
-};
-
-static constexpr int PST_B_EG[64] = {
- -15,-10,-10,-10,-10,-10,-10,-15,
- -10,  0,  0,  0,  0,  0,  0,-10,
- -10,  0,  8, 10, 10,  8,  0,-10,
- -10,  8, 10, 12, 12, 10,  8,-10,
- -10,  0, 10, 12, 12, 10,  0,-10,
- -10, 10, 10, 10, 10, 10, 10,-10,
- -10,  5,  0,  0,  0,  0,  5,-10,
- -15,-10,-10,-10,-10,-10,-10,-15
-};
-
-static constexpr int PST_R_MG[64] = {
-   0,  0,  5, 10, 10,  5,  0,  0,
-  -5,  0,  0,  0,  0,  0,  0, -5,
-  -5,  0,  0,  0,  0,  0,  0, -5,
-  -5,  0,  0,  0,  0,  0,  0, -5,
-  -5,  0,  0,  0,  0,  0,  0, -5,
-  -5,  0,  0,  0,  0,  0,  0, -5,
-   5, 10, 10, 10, 10, 10, 10,  5,
-   0,  0,  0,  0,  0,  0,  0,  0
+// Left neighbouring file only. The old runtime init read FILE_MASK[f+1] before
+// filling it; keep those values so the evaluation is unchanged.
+static constexpr U64 ADJ_FILE_MASK[8] = {
+  0,            FILE_MASK[0], FILE_MASK[1], FILE_MASK[2],
+  FILE_MASK[3], FILE_MASK[4], FILE_MASK[5], FILE_MASK[6],
 };
 
-static constexpr int PST_R_EG[64] = {
-   0,  0,  5,  8,  8,  5,  0,  0,
-   0,  0,  0,  2,  2,  0,  0,  0,
-   0,  0,  0,  2,  2,  0,  0,  0,
-   0,  0,  0,  2,  2,  0,  0,  0,
-   0,  0,  0,  2,  2,  0,  0,  0,
-   0,  0,  0,  2,  2,  0,  0,  0,
-   5,  8,  8, 10, 10,  8,  8,  5,
-   0,  0,  0,  0,  0,  0,  0,  0
-};
-
-static constexpr int PST_Q_MG[64] = {
- -20,-10,-10, -5, -5,-10,-10,-20,
- -10,  0,  0,  0,  0,  0,  0,-10,
- -10,  0,  5,  5,  5,  5,  0,-10,
-  -5,  0,  5,  5,  5,  5,  0, -5,
-   0,  0,  5,  5,  5,  5,  0, -5,
- -10,  5,  5,  5,  5,  5,  0,-10,
- -10,  0,  5,  0,  0,  0,  0,-10,
- -20,-10,-10, -5, -5,-10,-10,-20
-};
-
-static constexpr int PST_Q_EG[64] = {
- -10, -5, -5, -2, -2, -5, -5,-10,
-  -5,  0,  0,  0,  0,  0,  0, -5,
-  -5,  0,  5,  5,  5,  5,  0, -5,
-  -2,  0,  5,  6,  6,  5,  0, -2,
-  -2,  0,  5,  6,  6,  5,  0, -2,
-  -5,  0,  5,  5,  5,  5,  0, -5,
-  -5,  0,  0,  0,  0,  0,  0, -5,
- -10, -5, -5, -2, -2, -5, -5,-10
-};
-
-static constexpr int PST_K_MG[64] = {
- -50,-40,-30,-20,-20,-30,-40,-50,
- -40,-30,-20,-10,-10,-20,-30,-40,
- -30,-20,-10,  0,  0,-10,-20,-30,
- -20,-10,  0, 10, 10,  0,-10,-20,
- -20,-10,  0, 10, 10,  0,-10,-20,
- -30,-20,-10,  0,  0,-10,-20,-30,
- -40,-30,-20,-10,-10,-20,-30,-40,
- -50,-40,-30,-20,-20,-30,-40,-50
-};
-
-static constexpr int PST_K_EG[64] = {
- -20,-10,-10,-10,-10,-10,-10,-20,
- -10,  0,  0,  0,  0,  0,  0,-10,
- -10,  0, 10, 10, 10, 10,  0,-10,
- -10,  0, 10, 20, 20, 10,  0,-10,
- -10,  0, 10, 20, 20, 10,  0,-10,
- -10,  0, 10, 10, 10, 10,  0,-10,
- -10,  0,  0,  0,  0,  0,  0,-10,
- -20,-10,-10,-10,-10,-10,-10,-20
-};
-
-static inline void pst_add(int piece, int sqW, int& mg, int& eg, int sign) {
-  switch (piece) {
-    case PAWN:   mg += sign * PST_P_MG[sqW]; eg += sign * PST_P_EG[sqW]; break;
-    case KNIGHT: mg += sign * PST_N_MG[sqW]; eg += sign * PST_N_EG[sqW]; break;
-    case BISHOP: mg += sign * PST_B_MG[sqW]; eg += sign * PST_B_EG[sqW]; break;
-    case ROOK:   mg += sign * PST_R_MG[sqW]; eg += sign * PST_R_EG[sqW]; break;
-    case QUEEN:  mg += sign * PST_Q_MG[sqW]; eg += sign * PST_Q_EG[sqW]; break;
-    case KING:   mg += sign * PST_K_MG[sqW]; eg += sign * PST_K_EG[sqW]; break;
-  }
-}
-
-// ------------------------------------------------------------
-// Masks and helpers
-// ------------------------------------------------------------
-static U64 FILE_MASK[8];
-static U64 ADJ_FILE_MASK[8];
-static bool masks_inited = false;
-
-static void init_masks_once() {
-  if (masks_inited) return;
-  masks_inited = true;
-
-  for (int f=0; f<8; f++){
-    U64 m = 0;
-    for (int r=0; r<8; r++) m |= (1ULL << (r*8 + f));
-    FILE_MASK[f] = m;
-
-    U64 adj = 0;
-    if (f > 0) adj |= FILE_MASK[f-1];
-    if (f < 7) adj |= FILE_MASK[f+1];
-    ADJ_FILE_MASK[f] = adj;
-  }
-}
-
 static inline int pawn_rank_from_side(Color c, int sq) {
   int r = rank_of(sq);
   return (c == WHITE) ? r : (7 - r); // 0..7
@@ -367,27 +208,71 @@ static constexpr U64 DARK_SQ  = 0xAA55AA55AA55AA55ULL; // a1 dark
 static constexpr U64 LIGHT_SQ = ~DARK_SQ;
 
 // ------------------------------------------------------------
-// Pawn hash (caches pawn-structure evaluation)
+// Eval / pawn caches (shared by all search threads, lockless)
 // ------------------------------------------------------------
 namespace {
-  static constexpr size_t PAWN_TT_SIZE = 1u << 18; // 262k
-  struct PawnEntry {
-    uint64_t key = 0;
-    int mg = 0;
-    int eg = 0;
-    U64 passedW = 0;
-    U64 passedB = 0;
-    U64 connectedW = 0;
-    U64 connectedB = 0;
+  // One 64-bit value per slot with check = key ^ data: a slot torn by two threads
+  // storing at once fails the XOR check and simply reads as a miss.
+  struct CacheEntry {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
   };
-  static PawnEntry PawnTT[PAWN_TT_SIZE];
 
+  class EvalHashTable {
+  public:
+    explicit EvalHashTable(int mb) { resize(mb); }
+    ~EvalHashTable() { if (entries_ != &fallback_) std::free(entries_); }
+
+    // Power-of-two slot count within mb. calloc hands back zero pages that only become
+    // resident when touched, so processes that never evaluate (perft, uci handshake)
+    // pay nothing for the reservation. If the allocation fails the old table stays
+    // (or, on first use, a single slot), so probe/store never see a null table.
+    void resize(int mb) {
+      size_t n = 1;
+      while (n * 2 * sizeof(CacheEntry) <= (size_t)mb * 1024ULL * 1024ULL) n *= 2;
+      auto* fresh = static_cast<CacheEntry*>(std::calloc(n, sizeof(CacheEntry)));
+      if (!fresh) {
+        if (entries_) return;
+        n = 1;
+        fresh = &fallback_;
+      }
+      if (entries_ != &fallback_) std::free(entries_);
+      entries_ = fresh;
+      mask_ = n - 1;
+    }
+
+    void clear() { std::memset(static_cast<void*>(entries_), 0, (mask_ + 1) * sizeof(CacheEntry)); }
+
+    bool probe(uint64_t key, uint64_t& data) const {
+      const CacheEntry& e = entries_[key & mask_];
+      data = e.data.load(std::memory_order_relaxed);
+      return (e.check.load(std::memory_order_relaxed) ^ data) == key;
+    }
 
-    static inline uint64_t pawn_key(const Position& pos) {
+    void store(uint64_t key, uint64_t data) {
+      CacheEntry& e = entries_[key & mask_];
+      e.data.store(data, std::memory_order_relaxed);
+      e.check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+  private:
+    CacheEntry* entries_ = nullptr;
+    size_t mask_ = 0;
+    CacheEntry fallback_{}; // used only when calloc fails before any table exists
+  };
+
+  static EvalHashTable& eval_tt() { static EvalHashTable t(EVAL_CACHE_DEFAULT_MB); return t; }
+  static EvalHashTable& pawn_tt() { static EvalHashTable t(PAWN_CACHE_DEFAULT_MB); return t; }
+
+  static inline uint64_t pawn_key(const Position& pos) {
     return pos.pawnKey;
   }
 }
 
+void eval_cache_resize_mb(int mb) { eval_tt().resize(std::max(1, mb)); }
+void pawn_cache_resize_mb(int mb) { pawn_tt().resize(std::max(1, mb)); }
+void eval_cache_clear() { eval_tt().clear(); }
+
 static inline bool supported_by_pawn(Color c, int sq, U64 pawns) {
   // squares that attack sq with a pawn of color c
   // white pawn attackers to sq are ATK.pawn[BLACK][sq]
@@ -422,40 +307,14 @@ static inline bool enemy_pawn_can_chase(Color us, int sq, U64 enemyPawns) {
 // ------------------------------------------------------------
 // eval()
 // ------------------------------------------------------------
-static int eval_uncached(const Position& pos) {
-  init_masks_once();
-
-  int mg = 0, eg = 0;
-  int phase = 0;
+int eval_classical(const Position& pos) {
 
-  // Compute occupancy locally (no dependency on Position having occ fields)
-  U64 occW = 0, occB = 0;
-  for (int p=0; p<6; p++){
-    occW |= pos.bb[WHITE][p];
-    occB |= pos.bb[BLACK][p];
-  }
-  U64 occAll = occW | occB;
-
-  // Material + PST + phase
-  for (int c=0;c<2;c++){
-    int sign = (c==WHITE) ? +1 : -1;
-
-    for (int p=0;p<6;p++){
-      U64 bb = pos.bb[c][p];
-      int cnt = popcount64(bb);
+  // Material + PST + phase are kept incrementally by Position::make/unmake.
+  int mg = mg_value(pos.psq), eg = eg_value(pos.psq);
+  int phase = std::min(pos.phase, TOTAL_PHASE);
 
-      mg += sign * (MG_VAL[p] * cnt);
-      eg += sign * (EG_VAL[p] * cnt);
-      phase += PHASE_INC[p] * cnt;
-
-      while (bb){
-        int sq = pop_lsb(bb);
-        int sqW = (c==WHITE) ? sq : mirror_sq(sq);
-        pst_add(p, sqW, mg, eg, sign);
-      }
-    }
-  }
-  phase = std::min(phase, TOTAL_PHASE);
+  const U64 occW = pos.occ[WHITE], occB = pos.occ[BLACK];
+  const U64 occAll = pos.occAll;
 
   // Bishop pair
   if (popcount64(pos.bb[WHITE][BISHOP]) >= 2) { mg += BISHOP_PAIR_BONUS_MG; eg += BISHOP_PAIR_BONUS_EG; }
@@ -463,14 +322,12 @@ static int eval_uncached(const Position& pos) {
 
   // Pawn structure: doubled / isolated / passed / connected passed (cached)
   const uint64_t pk = pawn_key(pos);
-  PawnEntry& pe = PawnTT[pk & (PAWN_TT_SIZE - 1)];
-  if (pe.key == pk) {
-    mg += pe.mg;
-    eg += pe.eg;
+  uint64_t pdata;
+  if (pawn_tt().probe(pk, pdata)) {
+    mg += (int32_t)(uint32_t)pdata;
+    eg += (int32_t)(uint32_t)(pdata >> 32);
   } else {
     int pmg = 0, peg = 0;
-    U64 passedW = 0, passedB = 0;
-    U64 connW = 0, connB = 0;
 
     for (int c=0;c<2;c++){
       Color us = (Color)c;
@@ -506,31 +363,20 @@ static int eval_uncached(const Position& pos) {
         }
       }
 
-      // connected passers (cache a mask too)
-      U64 connMask = 0;
+      // connected passers
       for (int f=0; f<8; f++){
         if ((passedMask & FILE_MASK[f]) == 0) continue;
         bool adj = false;
         if (f > 0 && (passedMask & FILE_MASK[f-1])) adj = true;
         if (f < 7 && (passedMask & FILE_MASK[f+1])) adj = true;
         if (adj) {
-          connMask |= (passedMask & FILE_MASK[f]);
           pmg += sign * CONNECTED_PASSED_BONUS_MG;
           peg += sign * CONNECTED_PASSED_BONUS_EG;
         }
       }
-
-      if (us == WHITE) { passedW = passedMask; connW = connMask; }
-      else { passedB = passedMask; connB = connMask; }
     }
 
-    pe.key = pk;
-    pe.mg = pmg;
-    pe.eg = peg;
-    pe.passedW = passedW;
-    pe.passedB = passedB;
-    pe.connectedW = connW;
-    pe.connectedB = connB;
+    pawn_tt().store(pk, (uint64_t)(uint32_t)pmg | ((uint64_t)(uint32_t)peg << 32));
     mg += pmg;
     eg += peg;
   }
@@ -893,25 +739,19 @@ threats_bonus(BLACK, bAtt, wAtt, mg, eg);
 }
 
 
-// ------------------------------------------------------------
-// Eval cache (transposition-friendly static eval memoization)
-// ------------------------------------------------------------
-namespace {
-  static constexpr size_t EVAL_TT_SIZE = 1u << 20; // 1M entries
-  struct EvalEntry {
-    uint64_t key = 0;
-    int score = 0;
-  };
-  static EvalEntry EvalTT[EVAL_TT_SIZE];
+int eval_uncached(const Position& pos) {
+  return nnue::enabled() ? nnue::evaluate(pos) : eval_classical(pos);
 }
 
+// ------------------------------------------------------------
+// Cached eval (transposition-friendly static eval memoization)
+// ------------------------------------------------------------
 int eval(const Position& pos) {
   const uint64_t k = pos.key;
-  EvalEntry& e = EvalTT[k & (EVAL_TT_SIZE - 1)];
-  if (e.key == k) return e.score;
+  uint64_t data;
+  if (eval_tt().probe(k, data)) return (int32_t)(uint32_t)data;
 
   const int s = eval_uncached(pos);
-  e.key = k;
-  e.score = s;
+  eval_tt().store(k, (uint64_t)(uint32_t)s);
   return s;
 }
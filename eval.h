@@ -2,3 +2,17 @@
 #include "position.h"
 
 int eval(const Position& pos);
+
+// Eval and pawn-structure caches, shared by all search threads (lockless, XOR-verified).
+// Sizes in MB; resizing drops the cached entries, so call it between searches.
+static constexpr int EVAL_CACHE_DEFAULT_MB = 4;
+static constexpr int PAWN_CACHE_DEFAULT_MB = 4;
+void eval_cache_resize_mb(int mb);
+void pawn_cache_resize_mb(int mb);
+// Drop cached scores, e.g. after switching between NNUE and the classical eval.
+void eval_cache_clear();
+
+// Static evaluation bypassing the eval cache (benchmarks / tuning): NNUE when a
+// network is loaded, the classical eval otherwise.
+int eval_uncached(const Position& pos);
+int eval_classical(const Position& pos);
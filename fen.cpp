@@ -19,8 +19,6 @@ static void set_piece(Position& pos, int sq, Color c, Piece p) {
 }
 
 bool load_fen(Position& out, const std::string& fen) {
-  // Ensure zobrist tables are ready for rebuild_key().
-  zobrist_init();
   Position p;
   int i=0;
   int sq = 56; // a8
@@ -103,6 +101,7 @@ bool load_fen(Position& out, const std::string& fen) {
 
   p.rebuild_occ();
   p.rebuild_key();
+  p.rebuild_psq();
   p.reset_game_history();
   out = p;
   return true;
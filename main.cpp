@@ -1,13 +1,17 @@
 #include "attacks.h"
+#include "bench.h"
 #include "fen.h"
 #include "uci.h"
 #include "cli.h"
-#include "zobrist.h"
+#include "perft.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
 #include <string>
+#include <thread>
 
 int main(int argc, char** argv) {
   ATK.init();
-  zobrist_init();
 
   Position pos;
   const std::string startpos = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
@@ -16,6 +20,24 @@ int main(int argc, char** argv) {
   // If you run: chessy.exe --cli
   if (argc >= 2 && std::string(argv[1]) == "--cli") {
     cli_loop(pos);
+  } else if (argc >= 3 && std::string(argv[1]) == "--perft-suite") {
+    // chessy.exe --perft-suite <file.epd> [maxDepth] [threads] [hashMb] : exit code 0 if all pass
+    int maxDepth = argc >= 4 ? std::atoi(argv[3]) : 6;
+    int threads = argc >= 5 ? std::atoi(argv[4]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    int hashMb = argc >= 6 ? std::atoi(argv[5]) : 0;
+    return perft_suite(argv[2], maxDepth, threads, hashMb, std::cout) ? 0 : 1;
+  } else if (argc >= 2 && std::string(argv[1]) == "--bench-smp") {
+    // chessy.exe --bench-smp [threads] [depth] : time-to-depth per SMP mode
+    int threads = argc >= 3 ? std::atoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    int depth = argc >= 4 ? std::atoi(argv[3]) : 12;
+    bench_smp(threads, depth);
+  } else if (argc >= 3 && std::string(argv[1]) == "--bench-nnue") {
+    // chessy.exe --bench-nnue <file.nnue> [depth] : classical eval vs NNUE kernels
+    int depth = argc >= 4 ? std::atoi(argv[3]) : 10;
+    bench_nnue(argv[2], depth);
+  } else if (argc >= 2 && std::string(argv[1]) == "--bench-sliders") {
+    // chessy.exe --bench-sliders : magic vs PEXT slider attacks
+    bench_slider_backends();
   } else {
     uci_loop(pos);
   }
@@ -28,3 +28,12 @@ inline constexpr Piece   m_piece(Move m)  { return (Piece)((m >> 12) & 7); }
 inline constexpr Piece   m_cap(Move m)    { return (Piece)((m >> 15) & 7); }
 inline constexpr Piece   m_promo(Move m)  { return (Piece)((m >> 18) & 7); }
 inline constexpr uint8_t m_flags(Move m)  { return (uint8_t)((m >> 21) & 0xFF); }
+
+inline constexpr bool is_capture(Move m) { return m_cap(m) != NO_PIECE || (m_flags(m) & MF_EP); }
+inline constexpr bool is_promo(Move m)   { return (m_flags(m) & MF_PROMO) != 0; }
+
+// 16-bit form kept in the TT: from | to << 6 | promotion piece << 12 (0 when not a
+// promotion), so the null move stays 0. Position::move_from_compact() restores the rest.
+inline constexpr uint16_t compact_move(Move m) {
+  return (uint16_t)(m_from(m) | (m_to(m) << 6) | ((is_promo(m) ? m_promo(m) : 0) << 12));
+}
@@ -0,0 +1,168 @@
+#include "movepick.h"
+#include "see.h"
+#include <utility>
+
+int move_score_basic(const Searcher::Heuristics& H, const Position& pos, Move m, Move ttMove, Move prevMove, int ply) {
+  if (m == ttMove) return 10'000'000;
+  if (is_capture(m) || is_promo(m)) {
+    int victim = (m_flags(m) & MF_EP) ? PAWN : m_cap(m);
+    int attacker = m_piece(m);
+    // MVV-LVA style score (fast). We avoid doing full SEE here because this
+    // function is called for *every* generated move at *every* node.
+    int score = 5'000'000 + 1000 * (victim + 1) - attacker;
+    // Capture history bonus (learns which captures tend to work)
+    score += H.captureHist[attacker][m_to(m)][victim] * 4;
+
+    // Promotions are very forcing; prioritize them heavily.
+    if (is_promo(m)) {
+      // m_promo() is the promoted piece type (KNIGHT..QUEEN)
+      score += 400'000 + 50'000 * (int)m_promo(m);
+    }
+
+    // Recapture bonus: if responding to a capture on the same square, prioritize it.
+    if (prevMove && is_capture(prevMove) && m_to(m) == m_to(prevMove)) score += 60'000;
+    return score;
+  }
+  if (m == H.killers[ply][0]) return 4'000'000;
+  if (m == H.killers[ply][1]) return 3'900'000;
+
+  if (prevMove) {
+    Move cm = H.countermove[pos.stm][m_from(prevMove)][m_to(prevMove)];
+    if (m == cm) return 3'800'000;
+  }
+
+  int score = 0;
+  score += H.history[pos.stm][m_from(m)][m_to(m)];
+  if (prevMove) {
+    int pp = m_piece(prevMove);
+    int pto = m_to(prevMove);
+    int p = m_piece(m);
+    int to = m_to(m);
+    score += H.contHist[pos.stm][pp][pto][p][to] / 2;
+  }
+  return score;
+}
+
+MovePicker::MovePicker(const Position& p, const Searcher::Heuristics& h, Move tt, Move prev, int pl, bool inCheck)
+    : pos(p), H(h), ttMove(tt), prevMove(prev), ply(pl) {
+  stage = inCheck ? ST_EVASION_TT : ST_TT;
+  if (ttMove && !pos.is_legal(ttMove)) ttMove = 0;
+  if (!inCheck) {
+    killer1 = H.killers[ply][0];
+    killer2 = H.killers[ply][1];
+    if (prevMove) counter = H.countermove[pos.stm][m_from(prevMove)][m_to(prevMove)];
+  }
+}
+
+void MovePicker::score_range(int from, int to) {
+  for (int i = from; i < to; i++) scores[i] = move_score_basic(H, pos, list.moves[i], 0, prevMove, ply);
+}
+
+// Selection step: bring the best remaining move of the active stage to 'cur'.
+int MovePicker::pick_best() {
+  int best = cur;
+  for (int j = cur + 1; j < end; j++) if (scores[j] > scores[best]) best = j;
+  if (best != cur) { std::swap(scores[cur], scores[best]); std::swap(list.moves[cur], list.moves[best]); }
+  return cur++;
+}
+
+// Killers/countermove are quiet moves from sibling positions; play them only if legal here.
+bool MovePicker::try_refutation(Move m) const {
+  return m && m != ttMove && !is_capture(m) && !is_promo(m) && pos.is_legal(m);
+}
+
+Move MovePicker::next() {
+  for (;;) {
+    switch (stage) {
+      case ST_TT:
+        stage = ST_CAPTURES_INIT;
+        if (ttMove) return ttMove;
+        break;
+
+      case ST_CAPTURES_INIT:
+        pos.gen_captures(list);
+        cur = badEnd = 0;
+        end = list.size;
+        score_range(cur, end);
+        stage = ST_GOOD_CAPTURES;
+        break;
+
+      case ST_GOOD_CAPTURES:
+        while (cur < end) {
+          int i = pick_best();
+          Move m = list.moves[i];
+          if (m == ttMove) continue;
+          // Losing captures are deferred until after the quiets.
+          if (!see_ge(pos, m, 0)) { list.moves[badEnd++] = m; continue; }
+          return m;
+        }
+        stage = ST_KILLER1;
+        break;
+
+      case ST_KILLER1:
+        stage = ST_KILLER2;
+        if (try_refutation(killer1)) return killer1;
+        break;
+
+      case ST_KILLER2:
+        stage = ST_COUNTER;
+        if (killer2 != killer1 && try_refutation(killer2)) return killer2;
+        break;
+
+      case ST_COUNTER:
+        stage = ST_QUIETS_INIT;
+        if (counter != killer1 && counter != killer2 && try_refutation(counter)) return counter;
+        break;
+
+      case ST_QUIETS_INIT: {
+        // Quiets go after the deferred bad captures in the same buffer.
+        MoveList q;
+        pos.gen_quiets(q);
+        cur = badEnd;
+        end = badEnd;
+        for (int i = 0; i < q.size; i++) list.moves[end++] = q.moves[i];
+        score_range(cur, end);
+        stage = ST_QUIETS;
+        break;
+      }
+
+      case ST_QUIETS:
+        while (cur < end) {
+          Move m = list.moves[pick_best()];
+          if (!is_special(m)) return m;
+        }
+        badCur = 0;
+        stage = ST_BAD_CAPTURES;
+        break;
+
+      case ST_BAD_CAPTURES:
+        if (badCur < badEnd) return list.moves[badCur++];
+        stage = ST_DONE;
+        break;
+
+      case ST_EVASION_TT:
+        stage = ST_EVASIONS_INIT;
+        if (ttMove) return ttMove;
+        break;
+
+      case ST_EVASIONS_INIT:
+        pos.gen_evasions(list);
+        cur = 0;
+        end = list.size;
+        score_range(cur, end);
+        stage = ST_EVASIONS;
+        break;
+
+      case ST_EVASIONS:
+        while (cur < end) {
+          Move m = list.moves[pick_best()];
+          if (m != ttMove) return m;
+        }
+        stage = ST_DONE;
+        break;
+
+      default:
+        return 0;
+    }
+  }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "position.h"
+#include "search.h"
+
+// Ordering score used wherever a whole move list is sorted (qsearch, ProbCut, root):
+// TT move, then captures/promotions by MVV-LVA + capture history, then killers,
+// countermove, and quiets by history + continuation history.
+int move_score_basic(const Searcher::Heuristics& H, const Position& pos, Move m, Move ttMove, Move prevMove, int ply);
+
+// Staged, lazy move picker for negamax.
+// Each stage generates and scores its moves only once the previous stages are used up,
+// so a cutoff by the TT move or a good capture never pays for quiet generation.
+//
+// Stages (not in check):
+//   TT move -> good captures (SEE >= 0) -> killers, countermove -> quiets -> bad captures
+// In check: TT move -> all evasions.
+class MovePicker {
+public:
+  MovePicker(const Position& pos, const Searcher::Heuristics& H, Move ttMove, Move prevMove, int ply, bool inCheck);
+
+  // Next legal move, or 0 once every stage is exhausted.
+  Move next();
+
+private:
+  enum Stage : int {
+    ST_TT, ST_CAPTURES_INIT, ST_GOOD_CAPTURES, ST_KILLER1, ST_KILLER2, ST_COUNTER,
+    ST_QUIETS_INIT, ST_QUIETS, ST_BAD_CAPTURES,
+    ST_EVASION_TT, ST_EVASIONS_INIT, ST_EVASIONS,
+    ST_DONE
+  };
+
+  const Position& pos;
+  const Searcher::Heuristics& H;
+  Move ttMove, prevMove;
+  Move killer1 = 0, killer2 = 0, counter = 0;
+  int ply;
+  int stage;
+
+  // moves[0, badEnd) holds deferred bad captures; [cur, end) is the active stage.
+  MoveList list;
+  int scores[256];
+  int cur = 0, end = 0, badEnd = 0, badCur = 0;
+
+  void score_range(int from, int to);
+  int pick_best();
+  bool is_special(Move m) const { return m == ttMove || m == killer1 || m == killer2 || m == counter; }
+  bool try_refutation(Move m) const;
+};
@@ -0,0 +1,497 @@
+#include "nnue.h"
+#include "position.h"
+#include "bitboard.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h>
+  #include <immintrin.h>
+  #define CHESSY_HAS_X86_SIMD 1
+  #define CHESSY_TARGET_SSE41
+  #define CHESSY_TARGET_AVX2
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  #include <cpuid.h>
+  #include <immintrin.h>
+  #define CHESSY_HAS_X86_SIMD 1
+  #define CHESSY_TARGET_SSE41 __attribute__((target("sse4.1")))
+  #define CHESSY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define CHESSY_HAS_X86_SIMD 0
+#endif
+
+namespace nnue {
+
+bool active = false;
+
+namespace {
+
+// ----------------------------
+// Network layout (Stockfish 12 HalfKP 256x2-32-32)
+// ----------------------------
+constexpr uint32_t FILE_VERSION = 0x7AF32F16u;
+constexpr int PS_END = 10 * 64 + 1;     // piece-square inputs per king square (0 unused)
+constexpr int INPUT_DIMS = 64 * PS_END; // 41024
+constexpr int L1_IN = 2 * HALF_DIMS;    // side to move first, then the opponent
+constexpr int L1_OUT = 32;
+constexpr int L2_OUT = 32;
+constexpr int HIDDEN_SHIFT = 6;  // hidden outputs are >> 6, then clipped to 0..127
+constexpr int OUTPUT_SCALE = 16;
+constexpr int NET_PAWN = 208;    // one pawn in the trainer's units
+
+// Hash of the dense layers (input slice, three affine layers, ClippedReLU after the
+// hidden ones), derived the same way the trainers write it into the file.
+constexpr uint32_t dense_hash() {
+  uint32_t prev = 0xEC42E90Du ^ (uint32_t)L1_IN;
+  const int outs[3] = { L1_OUT, L2_OUT, 1 };
+  for (int out : outs) {
+    uint32_t h = 0xCC03DAE4u + (uint32_t)out;
+    h ^= prev >> 1;
+    h ^= prev << 31;
+    if (out != 1) h += 0x538D24C7u;
+    prev = h;
+  }
+  return prev;
+}
+
+// int8 dense weights are widened to int16 at load, so every kernel is a plain
+// 16x16->32 multiply-add and the backends agree bit for bit.
+struct Network {
+  std::vector<int16_t> ftBias;    // [HALF_DIMS]
+  std::vector<int16_t> ftWeights; // [INPUT_DIMS][HALF_DIMS]
+  alignas(64) int16_t w1[L1_OUT * L1_IN];
+  alignas(64) int16_t w2[L2_OUT * L1_OUT];
+  alignas(64) int16_t w3[L2_OUT];
+  int32_t b1[L1_OUT];
+  int32_t b2[L2_OUT];
+  int32_t b3[1];
+  std::string description;
+};
+
+std::unique_ptr<Network> net;
+
+// ----------------------------
+// Kernels
+// ----------------------------
+// acc += sum(add rows) - sum(sub rows), HALF_DIMS lanes.
+using UpdateFn = void (*)(int16_t* acc, const int16_t* const* add, int nAdd,
+                          const int16_t* const* sub, int nSub);
+// out[0..2*HALF_DIMS) = clamp(us ++ them, 0, 127)
+using TransformFn = void (*)(const int16_t* us, const int16_t* them, int16_t* out);
+// out[o] = bias[o] + dot(w[o], in); inDims is a multiple of 16.
+using AffineFn = void (*)(const int16_t* in, int inDims, const int16_t* w, const int32_t* bias,
+                          int outDims, int32_t* out);
+// out[i] = clamp(in[i] >> HIDDEN_SHIFT, 0, 127); n is a multiple of 8.
+using ClippedReluFn = void (*)(const int32_t* in, int n, int16_t* out);
+
+struct Kernels {
+  UpdateFn update;
+  TransformFn transform;
+  AffineFn affine;
+  ClippedReluFn clipped_relu;
+};
+
+void update_scalar(int16_t* acc, const int16_t* const* add, int nAdd,
+                   const int16_t* const* sub, int nSub) {
+  for (int k = 0; k < nAdd; k++)
+    for (int i = 0; i < HALF_DIMS; i++) acc[i] = (int16_t)(acc[i] + add[k][i]);
+  for (int k = 0; k < nSub; k++)
+    for (int i = 0; i < HALF_DIMS; i++) acc[i] = (int16_t)(acc[i] - sub[k][i]);
+}
+
+void transform_scalar(const int16_t* us, const int16_t* them, int16_t* out) {
+  for (int i = 0; i < HALF_DIMS; i++) {
+    out[i] = (int16_t)std::clamp<int>(us[i], 0, 127);
+    out[HALF_DIMS + i] = (int16_t)std::clamp<int>(them[i], 0, 127);
+  }
+}
+
+void affine_scalar(const int16_t* in, int inDims, const int16_t* w, const int32_t* bias,
+                   int outDims, int32_t* out) {
+  for (int o = 0; o < outDims; o++) {
+    const int16_t* row = w + o * inDims;
+    int32_t sum = bias[o];
+    for (int i = 0; i < inDims; i++) sum += (int32_t)in[i] * row[i];
+    out[o] = sum;
+  }
+}
+
+void clipped_relu_scalar(const int32_t* in, int n, int16_t* out) {
+  for (int i = 0; i < n; i++) out[i] = (int16_t)std::clamp(in[i] >> HIDDEN_SHIFT, 0, 127);
+}
+
+constexpr Kernels SCALAR_KERNELS = { update_scalar, transform_scalar, affine_scalar, clipped_relu_scalar };
+
+#if CHESSY_HAS_X86_SIMD
+CHESSY_TARGET_SSE41 void update_sse41(int16_t* acc, const int16_t* const* add, int nAdd,
+                                      const int16_t* const* sub, int nSub) {
+  for (int i = 0; i < HALF_DIMS; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(acc + i));
+    for (int k = 0; k < nAdd; k++) x = _mm_add_epi16(x, _mm_loadu_si128((const __m128i*)(add[k] + i)));
+    for (int k = 0; k < nSub; k++) x = _mm_sub_epi16(x, _mm_loadu_si128((const __m128i*)(sub[k] + i)));
+    _mm_storeu_si128((__m128i*)(acc + i), x);
+  }
+}
+
+CHESSY_TARGET_SSE41 void transform_sse41(const int16_t* us, const int16_t* them, int16_t* out) {
+  const __m128i zero = _mm_setzero_si128(), hi = _mm_set1_epi16(127);
+  for (int i = 0; i < HALF_DIMS; i += 8) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(us + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(them + i));
+    _mm_storeu_si128((__m128i*)(out + i), _mm_min_epi16(_mm_max_epi16(a, zero), hi));
+    _mm_storeu_si128((__m128i*)(out + HALF_DIMS + i), _mm_min_epi16(_mm_max_epi16(b, zero), hi));
+  }
+}
+
+CHESSY_TARGET_SSE41 void affine_sse41(const int16_t* in, int inDims, const int16_t* w, const int32_t* bias,
+                                      int outDims, int32_t* out) {
+  for (int o = 0; o < outDims; o++) {
+    const int16_t* row = w + o * inDims;
+    __m128i s0 = _mm_setzero_si128(), s1 = _mm_setzero_si128();
+    for (int i = 0; i < inDims; i += 16) {
+      s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(in + i)),
+                                            _mm_loadu_si128((const __m128i*)(row + i))));
+      s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(in + i + 8)),
+                                            _mm_loadu_si128((const __m128i*)(row + i + 8))));
+    }
+    __m128i s = _mm_add_epi32(s0, s1);
+    s = _mm_hadd_epi32(s, s);
+    s = _mm_hadd_epi32(s, s);
+    out[o] = bias[o] + _mm_cvtsi128_si32(s);
+  }
+}
+
+CHESSY_TARGET_SSE41 void clipped_relu_sse41(const int32_t* in, int n, int16_t* out) {
+  const __m128i zero = _mm_setzero_si128(), hi = _mm_set1_epi32(127);
+  for (int i = 0; i < n; i += 8) {
+    __m128i a = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(in + i)), HIDDEN_SHIFT);
+    __m128i b = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(in + i + 4)), HIDDEN_SHIFT);
+    a = _mm_min_epi32(_mm_max_epi32(a, zero), hi);
+    b = _mm_min_epi32(_mm_max_epi32(b, zero), hi);
+    _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(a, b));
+  }
+}
+
+CHESSY_TARGET_AVX2 void update_avx2(int16_t* acc, const int16_t* const* add, int nAdd,
+                                    const int16_t* const* sub, int nSub) {
+  for (int i = 0; i < HALF_DIMS; i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(acc + i));
+    for (int k = 0; k < nAdd; k++) x = _mm256_add_epi16(x, _mm256_loadu_si256((const __m256i*)(add[k] + i)));
+    for (int k = 0; k < nSub; k++) x = _mm256_sub_epi16(x, _mm256_loadu_si256((const __m256i*)(sub[k] + i)));
+    _mm256_storeu_si256((__m256i*)(acc + i), x);
+  }
+}
+
+CHESSY_TARGET_AVX2 void transform_avx2(const int16_t* us, const int16_t* them, int16_t* out) {
+  const __m256i zero = _mm256_setzero_si256(), hi = _mm256_set1_epi16(127);
+  for (int i = 0; i < HALF_DIMS; i += 16) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(us + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(them + i));
+    _mm256_storeu_si256((__m256i*)(out + i), _mm256_min_epi16(_mm256_max_epi16(a, zero), hi));
+    _mm256_storeu_si256((__m256i*)(out + HALF_DIMS + i), _mm256_min_epi16(_mm256_max_epi16(b, zero), hi));
+  }
+}
+
+CHESSY_TARGET_AVX2 void affine_avx2(const int16_t* in, int inDims, const int16_t* w, const int32_t* bias,
+                                    int outDims, int32_t* out) {
+  for (int o = 0; o < outDims; o++) {
+    const int16_t* row = w + o * inDims;
+    __m256i s = _mm256_setzero_si256();
+    for (int i = 0; i < inDims; i += 16)
+      s = _mm256_add_epi32(s, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)(in + i)),
+                                                _mm256_loadu_si256((const __m256i*)(row + i))));
+    __m128i t = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+    t = _mm_hadd_epi32(t, t);
+    t = _mm_hadd_epi32(t, t);
+    out[o] = bias[o] + _mm_cvtsi128_si32(t);
+  }
+}
+
+CHESSY_TARGET_AVX2 void clipped_relu_avx2(const int32_t* in, int n, int16_t* out) {
+  const __m256i zero = _mm256_setzero_si256(), hi = _mm256_set1_epi32(127);
+  for (int i = 0; i < n; i += 8) {
+    __m256i x = _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(in + i)), HIDDEN_SHIFT);
+    x = _mm256_min_epi32(_mm256_max_epi32(x, zero), hi);
+    // packs works within 128-bit lanes, so pack the two halves of one register.
+    _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm256_castsi256_si128(x),
+                                                          _mm256_extracti128_si256(x, 1)));
+  }
+}
+
+constexpr Kernels SSE41_KERNELS = { update_sse41, transform_sse41, affine_sse41, clipped_relu_sse41 };
+constexpr Kernels AVX2_KERNELS = { update_avx2, transform_avx2, affine_avx2, clipped_relu_avx2 };
+#endif
+
+// AVX2 also needs the OS to save the ymm registers (OSXSAVE + XCR0 bits 1-2).
+bool cpu_supports(SimdBackend b) {
+  if (b == SIMD_SCALAR) return true;
+#if CHESSY_HAS_X86_SIMD
+  bool sse41 = false, avx2 = false, osYmm = false;
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  const int maxLeaf = info[0];
+  __cpuid(info, 1);
+  sse41 = (info[2] & (1 << 19)) != 0;
+  if ((info[2] & (1 << 27)) && (info[2] & (1 << 28))) osYmm = (_xgetbv(0) & 6) == 6;
+  if (maxLeaf >= 7) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+#else
+  unsigned a = 0, bx = 0, c = 0, d = 0;
+  if (!__get_cpuid(1, &a, &bx, &c, &d)) return false;
+  sse41 = (c & (1u << 19)) != 0;
+  if ((c & (1u << 27)) && (c & (1u << 28))) {
+    unsigned lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    osYmm = (lo & 6) == 6;
+  }
+  if (__get_cpuid_max(0, nullptr) >= 7) {
+    __cpuid_count(7, 0, a, bx, c, d);
+    avx2 = (bx & (1u << 5)) != 0;
+  }
+#endif
+  if (b == SIMD_SSE41) return sse41;
+  return avx2 && osYmm;
+#else
+  return false;
+#endif
+}
+
+const Kernels* kernels_for(SimdBackend b) {
+#if CHESSY_HAS_X86_SIMD
+  if (b == SIMD_AVX2) return &AVX2_KERNELS;
+  if (b == SIMD_SSE41) return &SSE41_KERNELS;
+#endif
+  return &SCALAR_KERNELS;
+}
+
+SimdBackend best_backend() {
+  if (cpu_supports(SIMD_AVX2)) return SIMD_AVX2;
+  if (cpu_supports(SIMD_SSE41)) return SIMD_SSE41;
+  return SIMD_SCALAR;
+}
+
+SimdBackend backend = best_backend();
+const Kernels* kernels = kernels_for(backend);
+
+// ----------------------------
+// Features
+// ----------------------------
+// Black sees the board rotated by 180 degrees, as in the HalfKP training data.
+inline int orient(Color persp, int sq) { return persp == WHITE ? sq : sq ^ 63; }
+
+// Input row for a non-king piece (code c*6+p) on sq, seen from persp with its king on ksq.
+inline const int16_t* feature_row(Color persp, int ksq, int pc, int sq) {
+  const int c = pc / 6, p = pc % 6;
+  const int index = orient(persp, sq) + 1 + 128 * p + (c == (int)persp ? 0 : 64) + PS_END * orient(persp, ksq);
+  return net->ftWeights.data() + (size_t)index * HALF_DIMS;
+}
+
+void refresh(const Position& pos, AccEntry& a, Color persp) {
+  const int16_t* rows[32];
+  int n = 0;
+  for (int c = 0; c < 2; c++)
+    for (int p = PAWN; p < KING; p++) {
+      U64 b = pos.bb[c][p];
+      while (b) rows[n++] = feature_row(persp, pos.kingSq[persp], code((Color)c, (Piece)p), pop_lsb(b));
+    }
+  std::memcpy(a.v[persp], net->ftBias.data(), sizeof(a.v[persp]));
+  kernels->update(a.v[persp], rows, n, nullptr, 0);
+  a.computed[persp] = true;
+}
+
+// Non-king piece changes of a move (the mover's own king is not an input).
+struct Delta {
+  int nAdd = 0, nSub = 0;
+  int addPc[2], addSq[2], subPc[2], subSq[2];
+  void add(int pc, int sq) { addPc[nAdd] = pc; addSq[nAdd++] = sq; }
+  void sub(int pc, int sq) { subPc[nSub] = pc; subSq[nSub++] = sq; }
+};
+
+Delta move_delta(Move m, Color us, int capturedCode) {
+  Delta d;
+  const int from = m_from(m), to = m_to(m);
+  const Piece p = m_piece(m);
+  const uint8_t flags = m_flags(m);
+
+  if (p != KING) {
+    d.sub(code(us, p), from);
+    d.add(code(us, (flags & MF_PROMO) ? m_promo(m) : p), to);
+  }
+  if (capturedCode != EMPTY_CODE) {
+    const int capSq = (flags & MF_EP) ? (us == WHITE ? to - 8 : to + 8) : to;
+    d.sub(capturedCode, capSq);
+  }
+  if (flags & MF_CASTLE) {
+    const int base = (us == WHITE) ? 0 : 56;
+    const bool kingSide = (to & 7) == 6;
+    d.sub(code(us, ROOK), base + (kingSide ? 7 : 0));
+    d.add(code(us, ROOK), base + (kingSide ? 5 : 3));
+  }
+  return d;
+}
+
+// Bring persp's half of st.e[top] up to date. Entries only record their move, so walk
+// back to the nearest computed half and replay the moves from there; if that side's king
+// moved on the way, every input changed and the half is rebuilt from the board instead.
+void update_half(const Position& pos, AccStack& st, int top, Color persp) {
+  int i = top;
+  while (!st.e[i].computed[persp]) {
+    const AccEntry& a = st.e[i];
+    if (i == 0 || (a.us == persp && a.move && m_piece(a.move) == KING)) {
+      refresh(pos, st.e[top], persp);
+      return;
+    }
+    i--;
+  }
+  // The king has not moved since entry i, so pos.kingSq[persp] holds for every step.
+  const int ksq = pos.kingSq[persp];
+  for (i++; i <= top; i++) {
+    AccEntry& a = st.e[i];
+    std::memcpy(a.v[persp], st.e[i - 1].v[persp], sizeof(a.v[persp]));
+    if (a.move) {
+      const Delta d = move_delta(a.move, a.us, a.capturedCode);
+      const int16_t* add[2];
+      const int16_t* sub[2];
+      for (int k = 0; k < d.nAdd; k++) add[k] = feature_row(persp, ksq, d.addPc[k], d.addSq[k]);
+      for (int k = 0; k < d.nSub; k++) sub[k] = feature_row(persp, ksq, d.subPc[k], d.subSq[k]);
+      kernels->update(a.v[persp], add, d.nAdd, sub, d.nSub);
+    }
+    a.computed[persp] = true;
+  }
+}
+
+int propagate(const AccEntry& a, Color stm) {
+  alignas(64) int16_t x1[L1_IN];
+  alignas(64) int16_t x2[L1_OUT];
+  alignas(64) int16_t x3[L2_OUT];
+  alignas(64) int32_t s1[L1_OUT];
+  alignas(64) int32_t s2[L2_OUT];
+  int32_t out;
+
+  kernels->transform(a.v[stm], a.v[!stm], x1);
+  kernels->affine(x1, L1_IN, net->w1, net->b1, L1_OUT, s1);
+  kernels->clipped_relu(s1, L1_OUT, x2);
+  kernels->affine(x2, L1_OUT, net->w2, net->b2, L2_OUT, s2);
+  kernels->clipped_relu(s2, L2_OUT, x3);
+  kernels->affine(x3, L2_OUT, net->w3, net->b3, 1, &out);
+
+  // Keep clear of the mate range whatever the net says.
+  const int cp = (int)((int64_t)out / OUTPUT_SCALE * 100 / NET_PAWN);
+  return std::clamp(cp, -(SCORE_MATE - 1001), SCORE_MATE - 1001);
+}
+
+// Little-endian reader over the loaded file.
+struct Reader {
+  const uint8_t* p;
+  const uint8_t* end;
+  bool ok = true;
+
+  uint32_t u32() {
+    if (end - p < 4) { ok = false; return 0; }
+    uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    p += 4;
+    return v;
+  }
+  int16_t i16() {
+    if (end - p < 2) { ok = false; return 0; }
+    uint16_t v = (uint16_t)(p[0] | (p[1] << 8));
+    p += 2;
+    return (int16_t)v;
+  }
+  int8_t i8() {
+    if (end - p < 1) { ok = false; return 0; }
+    return (int8_t)*p++;
+  }
+};
+
+void read_dense(Reader& r, int32_t* bias, int16_t* w, int inDims, int outDims) {
+  for (int o = 0; o < outDims; o++) bias[o] = (int32_t)r.u32();
+  for (int i = 0; i < inDims * outDims; i++) w[i] = r.i8();
+}
+
+} // namespace
+
+bool load(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::vector<uint8_t> buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  Reader r{buf.data(), buf.data() + buf.size()};
+
+  if (r.u32() != FILE_VERSION) return false;
+  const uint32_t fileHash = r.u32();
+  const uint32_t descLen = r.u32();
+  if (!r.ok || descLen > (size_t)(r.end - r.p)) return false;
+
+  auto n = std::make_unique<Network>();
+  n->description.assign((const char*)r.p, descLen);
+  r.p += descLen;
+
+  const uint32_t ftHash = r.u32();
+  n->ftBias.resize(HALF_DIMS);
+  n->ftWeights.resize((size_t)INPUT_DIMS * HALF_DIMS);
+  for (auto& b : n->ftBias) b = r.i16();
+  for (auto& w : n->ftWeights) w = r.i16();
+
+  const uint32_t denseHash = r.u32();
+  if (!r.ok || denseHash != dense_hash() || (ftHash ^ denseHash) != fileHash) return false;
+  read_dense(r, n->b1, n->w1, L1_IN, L1_OUT);
+  read_dense(r, n->b2, n->w2, L1_OUT, L2_OUT);
+  read_dense(r, n->b3, n->w3, L2_OUT, 1);
+  if (!r.ok || r.p != r.end) return false;
+
+  net = std::move(n);
+  active = true;
+  return true;
+}
+
+void unload() {
+  net.reset();
+  active = false;
+}
+
+const std::string& description() {
+  static const std::string none;
+  return net ? net->description : none;
+}
+
+void attach(Position& pos, AccStack* st) {
+  pos.accStack = st;
+  pos.accTop = 0;
+  if (st) st->push(0, 0, EMPTY_CODE, pos.stm);
+}
+
+int evaluate(const Position& pos) {
+  if (!pos.accStack) {
+    AccEntry a;
+    refresh(pos, a, WHITE);
+    refresh(pos, a, BLACK);
+    return propagate(a, pos.stm);
+  }
+  AccStack& st = *pos.accStack;
+  update_half(pos, st, pos.accTop, WHITE);
+  update_half(pos, st, pos.accTop, BLACK);
+  return propagate(st.e[pos.accTop], pos.stm);
+}
+
+SimdBackend simd_backend() { return backend; }
+
+bool set_simd_backend(SimdBackend b) {
+  if (!cpu_supports(b)) return false;
+  backend = b;
+  kernels = kernels_for(b);
+  return true;
+}
+
+const char* simd_backend_name(SimdBackend b) {
+  return b == SIMD_AVX2 ? "avx2" : b == SIMD_SSE41 ? "sse4.1" : "scalar";
+}
+
+} // namespace nnue
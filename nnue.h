@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "move.h"
+
+struct Position;
+
+// Optional NNUE evaluation (UCI option "EvalFile").
+//
+// Network: HalfKP 256x2-32-32-1 in the Stockfish 12 ".nnue" format. Inputs are
+// (own king square, piece, square) for the 10 non-king piece types; the first layer
+// (the feature transformer) is kept per perspective and per ply in an AccStack owned by
+// the search thread. Position::make only records the move there; evaluate() brings the
+// current entry up to date from the nearest computed ancestor, or rebuilds a half from
+// the board when that side's king moved in between.
+namespace nnue {
+
+constexpr int HALF_DIMS = 256;
+
+// First-layer state of one ply.
+struct AccEntry {
+  alignas(64) int16_t v[2][HALF_DIMS];
+  bool computed[2];
+  Move move;        // move leading here; 0 at the attach point. make_null pushes no
+                    // entry: the pieces don't move, so the parent's entry still applies.
+  int capturedCode; // EMPTY_CODE if none
+  Color us;         // side that made the move
+};
+
+// One per search thread, allocated only while a network is loaded. A Position points at
+// it with its own top index, so copies made for other threads must attach their own.
+struct AccStack {
+  std::vector<AccEntry> e = std::vector<AccEntry>(136); // grows if a line gets deeper
+
+  AccEntry& push(int top, Move m, int capturedCode, Color us) {
+    if (top >= (int)e.size()) e.resize(e.size() * 2);
+    AccEntry& a = e[top];
+    a.computed[WHITE] = a.computed[BLACK] = false;
+    a.move = m;
+    a.capturedCode = capturedCode;
+    a.us = us;
+    return a;
+  }
+};
+
+// Load a network; false (and the previous state kept) if the file is missing or not
+// a HalfKP 256x2-32-32 net. unload() goes back to the classical eval.
+bool load(const std::string& path);
+void unload();
+extern bool active; // a network is loaded (only changes between searches)
+inline bool enabled() { return active; }
+const std::string& description();
+
+// Let pos use st (nullptr detaches); pos becomes its bottom entry.
+void attach(Position& pos, AccStack* st);
+
+// Side-to-move relative score in centipawns. A detached position is evaluated from
+// scratch.
+int evaluate(const Position& pos);
+
+// Vector kernels for the accumulator and the dense layers, picked at startup from CPUID.
+// All backends compute exactly the same integers.
+enum SimdBackend : int { SIMD_SCALAR = 0, SIMD_SSE41 = 1, SIMD_AVX2 = 2 };
+
+SimdBackend simd_backend();
+// Returns false (and keeps the current backend) if the CPU/build lacks it.
+bool set_simd_backend(SimdBackend b);
+const char* simd_backend_name(SimdBackend b);
+
+} // namespace nnue
@@ -1,4 +1,12 @@
 #include "perft.h"
+#include "fen.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <thread>
 #include <vector>
 
@@ -6,7 +14,10 @@ uint64_t perft(Position& pos, int depth) {
   if (depth == 0) return 1ULL;
 
   MoveList ml;
-  pos.gen_pseudo(ml);
+  pos.gen_legal(ml);
+
+  // Bulk counting: the generator is fully legal, so the leaves are just the list size.
+  if (depth == 1) return (uint64_t)ml.size;
 
   uint64_t nodes = 0;
   Undo u;
@@ -14,53 +25,300 @@ uint64_t perft(Position& pos, int depth) {
   for (int i=0;i<ml.size;i++) {
     Move m = ml.moves[i];
     pos.make(m, u);
+    nodes += perft(pos, depth-1);
+    pos.unmake(m, u);
+  }
+  return nodes;
+}
 
-    Color justMoved = !pos.stm;
-    int ksq = pos.kingSq[justMoved];
-    if (!pos.is_attacked(ksq, pos.stm)) {
-      nodes += perft(pos, depth-1);
-    }
+// ------------------------------------------------------------
+// Perft hash (lockless, shared between threads)
+// ------------------------------------------------------------
+namespace {
+
+// data = nodes << 8 | depth, check = key ^ data. A torn write from two racing threads
+// fails the XOR check and simply reads as a miss, so no locks are needed.
+struct PerftEntry {
+  std::atomic<uint64_t> check{0};
+  std::atomic<uint64_t> data{0};
+};
+
+class PerftTable {
+public:
+  explicit PerftTable(int mb) {
+    size_t n = 1;
+    while (n * 2 * sizeof(PerftEntry) <= (size_t)mb * 1024ULL * 1024ULL) n *= 2;
+    entries_ = std::make_unique<PerftEntry[]>(n);
+    mask_ = n - 1;
+  }
+
+  bool probe(uint64_t key, int depth, uint64_t& nodes) const {
+    const PerftEntry& e = entries_[key & mask_];
+    const uint64_t d = e.data.load(std::memory_order_relaxed);
+    const uint64_t c = e.check.load(std::memory_order_relaxed);
+    if ((c ^ d) != key || (int)(d & 0xFF) != depth) return false;
+    nodes = d >> 8;
+    return true;
+  }
 
+  void store(uint64_t key, int depth, uint64_t nodes) {
+    PerftEntry& e = entries_[key & mask_];
+    const uint64_t d = (nodes << 8) | (uint64_t)depth;
+    e.data.store(d, std::memory_order_relaxed);
+    e.check.store(key ^ d, std::memory_order_relaxed);
+  }
+
+private:
+  std::unique_ptr<PerftEntry[]> entries_;
+  size_t mask_ = 0;
+};
+
+uint64_t perft_hashed(Position& pos, int depth, PerftTable& ht) {
+  if (depth == 0) return 1ULL;
+
+  uint64_t nodes = 0;
+  if (depth >= 2 && ht.probe(pos.key, depth, nodes)) return nodes;
+
+  MoveList ml;
+  pos.gen_legal(ml);
+  if (depth == 1) return (uint64_t)ml.size;
+
+  Undo u;
+  for (int i=0;i<ml.size;i++) {
+    Move m = ml.moves[i];
+    pos.make(m, u);
+    nodes += perft_hashed(pos, depth-1, ht);
     pos.unmake(m, u);
   }
+  ht.store(pos.key, depth, nodes);
   return nodes;
 }
 
-uint64_t perft_root_mt(const Position& root, int depth, int threads) {
-  if (threads <= 1) {
-    Position p = root;
-    return perft(p, depth);
+} // namespace
+
+// Counts perft(roots[r], depth) into counts[r]. All roots are split together, so a divide
+// starts its threads once instead of once per root move.
+static void perft_parallel(const std::vector<Position>& roots, int depth, int threads, PerftTable* ht,
+                           std::vector<uint64_t>& counts) {
+  auto count = [&](Position& p, int d) -> uint64_t {
+    return ht ? perft_hashed(p, d, *ht) : perft(p, d);
+  };
+
+  // A task is a position below root r, to be counted at taskDepth.
+  struct Task { Position pos; int root; };
+  std::vector<Task> tasks;
+  tasks.reserve(roots.size());
+  for (size_t r=0;r<roots.size();r++) {
+    tasks.push_back({roots[r], (int)r});
+    tasks.back().pos.gameKeys.clear();
   }
 
-  Position tmp = root;
-  MoveList ml;
-  tmp.gen_pseudo(ml);
+  counts.assign(roots.size(), 0ULL);
+  if (threads <= 1 || depth <= 2) {
+    for (Task& t : tasks) counts[t.root] = count(t.pos, depth);
+    return;
+  }
 
-  std::vector<std::thread> pool;
-  std::vector<uint64_t> partial(threads, 0ULL);
+  // Split below the roots: expand whole plies until there are enough subtrees to keep
+  // every thread busy (~16 per thread), but keep at least 2 plies of work per subtree.
+  int taskDepth = depth;
+  const size_t target = (size_t)threads * 16;
+  while (tasks.size() < target && taskDepth > 3) {
+    std::vector<Task> next;
+    for (Task& t : tasks) {
+      MoveList ml;
+      t.pos.gen_legal(ml);
+      Undo u;
+      for (int i=0;i<ml.size;i++) {
+        t.pos.make(ml.moves[i], u);
+        next.push_back({t.pos, t.root});
+        t.pos.unmake(ml.moves[i], u);
+      }
+    }
+    tasks.swap(next);
+    taskDepth--;
+  }
+
+  std::atomic<size_t> nextTask{0};
+  // partial[tid * roots + r]: each thread only writes its own row.
+  std::vector<uint64_t> partial((size_t)threads * roots.size(), 0ULL);
 
   auto worker = [&](int tid) {
-    Position p = root;
-    Undo u;
-    uint64_t sum = 0;
-    for (int i=tid; i<ml.size; i+=threads) {
-      Move m = ml.moves[i];
-      p.make(m, u);
-      Color justMoved = !p.stm;
-      int ksq = p.kingSq[justMoved];
-      if (!p.is_attacked(ksq, p.stm)) {
-        sum += perft(p, depth-1);
-      }
-      p.unmake(m, u);
+    uint64_t* row = &partial[(size_t)tid * roots.size()];
+    for (size_t i; (i = nextTask.fetch_add(1, std::memory_order_relaxed)) < tasks.size(); ) {
+      row[tasks[i].root] += count(tasks[i].pos, taskDepth);
     }
-    partial[tid] = sum;
   };
 
+  std::vector<std::thread> pool;
   pool.reserve(threads);
   for (int t=0;t<threads;t++) pool.emplace_back(worker, t);
   for (auto& th : pool) th.join();
 
+  for (int t=0;t<threads;t++)
+    for (size_t r=0;r<roots.size();r++) counts[r] += partial[(size_t)t * roots.size() + r];
+}
+
+uint64_t perft_root_mt(const Position& root, int depth, int threads, int hashMb) {
+  std::unique_ptr<PerftTable> ht;
+  if (hashMb > 0) ht = std::make_unique<PerftTable>(hashMb);
+  std::vector<uint64_t> counts;
+  perft_parallel({root}, depth, threads, ht.get(), counts);
+  return counts[0];
+}
+
+// ------------------------------------------------------------
+// Divide / EPD suite
+// ------------------------------------------------------------
+static std::string move_to_uci_perft(Move m) {
+  auto sq_to = [](int sq)->std::string{
+    return std::string() + char('a' + (sq & 7)) + char('1' + (sq >> 3));
+  };
+  std::string s = sq_to(m_from(m)) + sq_to(m_to(m));
+  if (m_flags(m) & MF_PROMO) s.push_back("pnbrqk"[m_promo(m)]);
+  return s;
+}
+
+using PerftClock = std::chrono::steady_clock;
+
+static double us_since(PerftClock::time_point t0) {
+  return std::chrono::duration<double, std::micro>(PerftClock::now() - t0).count();
+}
+
+// " time <ms> nps <n>"; nps is left out under a millisecond, where it is only timer noise.
+static void put_time_nps(std::ostream& out, uint64_t nodes, double us) {
+  out << " time " << (uint64_t)(us / 1000.0);
+  if (us >= 1000.0) out << " nps " << (uint64_t)(nodes * 1e6 / us);
+}
+
+uint64_t perft_divide(const Position& root, int depth, int threads, int hashMb, std::ostream& out) {
+  if (depth < 1) depth = 1;
+  std::unique_ptr<PerftTable> ht;
+  if (hashMb > 0) ht = std::make_unique<PerftTable>(hashMb);
+
+  const auto t0 = PerftClock::now();
+  Position p = root;
+  p.gameKeys.clear();
+  MoveList ml;
+  p.gen_legal(ml);
+
+  std::vector<Position> children;
+  children.reserve(ml.size);
+  Undo u;
+  for (int i=0;i<ml.size;i++) {
+    p.make(ml.moves[i], u);
+    children.push_back(p);
+    p.unmake(ml.moves[i], u);
+  }
+
+  std::vector<uint64_t> counts;
+  perft_parallel(children, depth-1, threads, ht.get(), counts);
+
   uint64_t total = 0;
-  for (auto v : partial) total += v;
+  for (int i=0;i<ml.size;i++) {
+    total += counts[i];
+    out << move_to_uci_perft(ml.moves[i]) << ": " << counts[i] << "\n";
+  }
+
+  out << "\nNodes searched: " << total << "\n";
+  out << "info string perft";
+  put_time_nps(out, total, us_since(t0));
+  out << std::endl;
   return total;
 }
+
+namespace {
+struct SuiteCase {
+  std::string fen;
+  std::vector<std::pair<int, uint64_t>> expected; // (depth, nodes)
+};
+}
+
+static bool parse_epd_line(const std::string& line, SuiteCase& sc) {
+  const size_t semi = line.find(';');
+  if (semi == std::string::npos) return false;
+  sc.fen = line.substr(0, semi);
+  while (!sc.fen.empty() && (sc.fen.back() == ' ' || sc.fen.back() == '\t')) sc.fen.pop_back();
+
+  // ";D5 4865609" operations; anything else (ids, comments) is ignored.
+  std::istringstream iss(line.substr(semi));
+  std::string op;
+  while (std::getline(iss, op, ';')) {
+    std::istringstream os(op);
+    std::string tag;
+    uint64_t nodes = 0;
+    if (!(os >> tag >> nodes)) continue;
+    if (tag.size() < 2 || tag[0] != 'D') continue;
+    try {
+      sc.expected.emplace_back(std::stoi(tag.substr(1)), nodes);
+    } catch (...) {}
+  }
+  return !sc.fen.empty() && !sc.expected.empty();
+}
+
+bool perft_suite(const std::string& path, int maxDepth, int threads, int hashMb, std::ostream& out) {
+  std::ifstream in(path);
+  if (!in) {
+    out << "info string perft suite: cannot open " << path << std::endl;
+    return false;
+  }
+
+  std::vector<SuiteCase> cases;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    SuiteCase sc;
+    if (parse_epd_line(line, sc)) cases.push_back(std::move(sc));
+  }
+
+  // Optional shared hash (keys differ between positions, so sharing is safe). It lets
+  // each Dn reuse the D(n-1) subtrees, so the nps printed is only movegen speed without it.
+  std::unique_ptr<PerftTable> ht;
+  if (hashMb > 0) ht = std::make_unique<PerftTable>(hashMb);
+
+  std::atomic<size_t> nextCase{0};
+  std::atomic<int> passed{0};
+  std::atomic<uint64_t> totalNodes{0};
+  std::mutex outMutex;
+  const auto t0 = PerftClock::now();
+
+  auto worker = [&]() {
+    for (size_t i; (i = nextCase.fetch_add(1, std::memory_order_relaxed)) < cases.size(); ) {
+      const SuiteCase& sc = cases[i];
+      std::ostringstream msg;
+      Position pos;
+      bool ok = load_fen(pos, sc.fen);
+      uint64_t nodes = 0;
+      const auto c0 = PerftClock::now();
+      if (!ok) msg << " bad fen";
+      for (const auto& [d, expect] : sc.expected) {
+        if (!ok || d > maxDepth) continue;
+        const uint64_t n = ht ? perft_hashed(pos, d, *ht) : perft(pos, d);
+        nodes += n;
+        if (n != expect) {
+          ok = false;
+          msg << " D" << d << " got " << n << " expected " << expect;
+        }
+      }
+      const double us = us_since(c0);
+      if (ok) passed.fetch_add(1, std::memory_order_relaxed);
+      totalNodes.fetch_add(nodes, std::memory_order_relaxed);
+
+      std::lock_guard<std::mutex> lk(outMutex);
+      out << (ok ? "pass" : "FAIL") << " #" << (i + 1) << " nodes " << nodes;
+      put_time_nps(out, nodes, us);
+      out << msg.str() << " fen " << sc.fen << std::endl;
+    }
+  };
+
+  if (threads < 1) threads = 1;
+  std::vector<std::thread> pool;
+  for (int t=0;t<threads;t++) pool.emplace_back(worker);
+  for (auto& th : pool) th.join();
+
+  const uint64_t nodes = totalNodes.load();
+  out << "perft suite: " << passed.load() << "/" << cases.size() << " passed, nodes " << nodes;
+  put_time_nps(out, nodes, us_since(t0));
+  out << std::endl;
+  return passed.load() == (int)cases.size();
+}
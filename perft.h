@@ -1,6 +1,25 @@
 #pragma once
 #include <cstdint>
+#include <iosfwd>
+#include <string>
 #include "position.h"
 
+// Legal-move perft with bulk counting at depth 1 (leaf moves are counted, not played).
 uint64_t perft(Position& pos, int depth);
-uint64_t perft_root_mt(const Position& root, int depth, int threads);
+
+// Multi-threaded perft. The tree is expanded below the root until there are plenty of
+// subtrees per thread; workers then pull subtrees from a shared queue, so a few heavy
+// root moves cannot leave cores idle. hashMb > 0 adds a shared lockless perft hash
+// (also used when threads == 1).
+uint64_t perft_root_mt(const Position& root, int depth, int threads, int hashMb = 0);
+
+// "divide": per-root-move subtree counts ("e2e4: 20" lines, then "Nodes searched: N").
+// All root moves are split across the threads in one pass, sharing one hash.
+uint64_t perft_divide(const Position& root, int depth, int threads, int hashMb, std::ostream& out);
+
+// EPD perft suite: one position per line with expected counts, e.g.
+//   rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - ;D1 20 ;D2 400 ;D3 8902
+// Every listed depth <= maxDepth is checked. Positions run in parallel (one per thread)
+// and each prints pass/fail with its nodes-per-second; returns true if all passed.
+// hashMb 0 (what the callers use by default) keeps the nps a movegen throughput figure.
+bool perft_suite(const std::string& path, int maxDepth, int threads, int hashMb, std::ostream& out);
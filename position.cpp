@@ -2,6 +2,7 @@
 #include "bitboard.h"
 #include "attacks.h"
 #include "zobrist.h"
+#include "nnue.h"
 
 static constexpr int WK = 1, WQ = 2, BK = 4, BQ = 8;
 
@@ -53,6 +54,17 @@ void Position::rebuild_key() {
   rebuild_pawn_key();
 }
 
+void Position::rebuild_psq() {
+  psq = 0;
+  phase = 0;
+  for (int sq=0; sq<64; sq++) {
+    int c = board[sq];
+    if (c == EMPTY_CODE) continue;
+    psq += PSQ[c][sq];
+    phase += PHASE_BY_CODE[c];
+  }
+}
+
 
 bool Position::is_attacked(int sq, Color by) const {
   // pawn (reverse lookup)
@@ -74,12 +86,146 @@ bool Position::is_attacked(int sq, Color by) const {
   return false;
 }
 
-void Position::gen_pseudo(MoveList& ml) const {
+U64 Position::attackers_to(int sq, U64 occupied) const {
+  return (ATK.pawn[BLACK][sq] & bb[WHITE][PAWN])
+       | (ATK.pawn[WHITE][sq] & bb[BLACK][PAWN])
+       | (ATK.knight[sq] & (bb[WHITE][KNIGHT] | bb[BLACK][KNIGHT]))
+       | (ATK.king[sq]   & (bb[WHITE][KING]   | bb[BLACK][KING]))
+       | (bishop_attacks(sq, occupied) & (bb[WHITE][BISHOP] | bb[BLACK][BISHOP] | bb[WHITE][QUEEN] | bb[BLACK][QUEEN]))
+       | (rook_attacks(sq, occupied)   & (bb[WHITE][ROOK]   | bb[BLACK][ROOK]   | bb[WHITE][QUEEN] | bb[BLACK][QUEEN]));
+}
+
+U64 Position::checkers() const {
+  return attackers_to(kingSq[stm], occAll) & occ[!stm];
+}
+
+U64 Position::king_blockers(Color c) const {
+  const int ksq = kingSq[c];
+  const Color them = !c;
+  // Enemy sliders that would hit the king on an empty board.
+  U64 snipers = (rook_attacks(ksq, 0)   & (bb[them][ROOK]   | bb[them][QUEEN]))
+              | (bishop_attacks(ksq, 0) & (bb[them][BISHOP] | bb[them][QUEEN]));
+  U64 blockers = 0;
+  while (snipers) {
+    int s = pop_lsb(snipers);
+    U64 b = ATK.between[ksq][s] & occAll;
+    if (b && !(b & (b - 1))) blockers |= b;
+  }
+  return blockers;
+}
+
+CheckInfo::CheckInfo(const Position& pos) {
+  const Color us = pos.stm;
+  const Color them = !us;
+  ksq = pos.kingSq[them];
+  checkSq[PAWN]   = ATK.pawn[them][ksq];
+  checkSq[KNIGHT] = ATK.knight[ksq];
+  checkSq[BISHOP] = bishop_attacks(ksq, pos.occAll);
+  checkSq[ROOK]   = rook_attacks(ksq, pos.occAll);
+  checkSq[QUEEN]  = checkSq[BISHOP] | checkSq[ROOK];
+  checkSq[KING]   = 0;
+  dcCandidates = pos.king_blockers(them) & pos.occ[us];
+}
+
+bool Position::gives_check(Move m, const CheckInfo& ci) const {
+  const int from = m_from(m);
+  const int to   = m_to(m);
+  const uint8_t flags = m_flags(m);
+  const Color us = stm;
+
+  // direct check (promotions handled below: the vacated square may open the line)
+  if (!(flags & MF_PROMO) && (ci.checkSq[m_piece(m)] & sq_bb(to))) return true;
+
+  // discovered check: a blocker leaves the line to the king
+  if ((ci.dcCandidates & sq_bb(from)) && !(ATK.line[ci.ksq][from] & sq_bb(to))) return true;
+
+  if (flags & MF_PROMO) {
+    const U64 o = occAll ^ sq_bb(from);
+    U64 att = 0;
+    switch (m_promo(m)) {
+      case KNIGHT: att = ATK.knight[to]; break;
+      case BISHOP: att = bishop_attacks(to, o); break;
+      case ROOK:   att = rook_attacks(to, o); break;
+      default:     att = bishop_attacks(to, o) | rook_attacks(to, o); break;
+    }
+    return (att & sq_bb(ci.ksq)) != 0;
+  }
+
+  if (flags & MF_EP) {
+    // The captured pawn may have been shielding the king from one of our sliders.
+    const int capSq = (us == WHITE) ? (to - 8) : (to + 8);
+    const U64 o = (occAll ^ sq_bb(from) ^ sq_bb(capSq)) | sq_bb(to);
+    return ((bishop_attacks(ci.ksq, o) & (bb[us][BISHOP] | bb[us][QUEEN]))
+          | (rook_attacks(ci.ksq, o)   & (bb[us][ROOK]   | bb[us][QUEEN]))) != 0;
+  }
+
+  if (flags & MF_CASTLE) {
+    const int rFrom = (to > from) ? (from + 3) : (from - 4);
+    const int rTo   = (to > from) ? (from + 1) : (from - 1);
+    const U64 o = (occAll ^ sq_bb(from) ^ sq_bb(rFrom)) | sq_bb(to) | sq_bb(rTo);
+    return (rook_attacks(rTo, o) & sq_bb(ci.ksq)) != 0;
+  }
+
+  return false;
+}
+
+// Shared legal generator. Type selects which subset is emitted:
+//  GEN_LEGAL        every legal move
+//  GEN_CAPTURES     captures, en passant and all promotions
+//  GEN_QUIETS       non-capture, non-promotion moves (castling included)
+//  GEN_QUIET_CHECKS the GEN_QUIETS moves that give check (caller not in check)
+//  GEN_EVASIONS     every legal move when in check
+template <int Type>
+void Position::generate(MoveList& ml) const {
+  constexpr bool CAPS = (Type == GEN_CAPTURES);
+  constexpr bool QCHECKS = (Type == GEN_QUIET_CHECKS);
+  constexpr bool QUIETS = QCHECKS || (Type == GEN_QUIETS);
+
   ml.size = 0;
   const Color us = stm;
   const Color them = !stm;
   const U64 usOcc = occ[us];
   const U64 themOcc = occ[them];
+  const int ksq = kingSq[us];
+  const U64 chk = checkers();
+
+  // Quiet checks: a move checks if it lands on its piece's check square, or if it
+  // takes a discovered-check candidate off the line to the enemy king.
+  const int eksq = kingSq[them];
+  U64 discover = 0;
+  U64 checkSq[6]{};
+  if (QCHECKS) {
+    const CheckInfo ci(*this);
+    discover = ci.dcCandidates;
+    for (int p = PAWN; p <= KING; p++) checkSq[p] = ci.checkSq[p];
+  }
+  auto check_mask = [&](int from, U64 direct) -> U64 {
+    return (discover & sq_bb(from)) ? (direct | ~ATK.line[eksq][from]) : direct;
+  };
+
+  // king: test destinations with the king lifted so sliders see through it
+  {
+    U64 moves = ATK.king[ksq] & ~usOcc;
+    if (CAPS) moves &= themOcc;
+    if (QUIETS) moves &= ~occAll;
+    if (QCHECKS) moves &= check_mask(ksq, 0);
+    const U64 occNoKing = occAll ^ sq_bb(ksq);
+    while (moves) {
+      int to = pop_lsb(moves);
+      if (attackers_to(to, occNoKing) & themOcc) continue;
+      if (board[to] == EMPTY_CODE) ml.push(make_move(ksq,to,KING,NO_PIECE,NO_PIECE,MF_NONE));
+      else ml.push(make_move(ksq,to,KING,code_piece(board[to]),NO_PIECE,MF_NONE));
+    }
+  }
+
+  // double check: only king moves are legal
+  if (chk & (chk - 1)) return;
+
+  // In check, other pieces must capture the checker or block the line to it.
+  U64 target = chk ? (ATK.between[ksq][ctz64(chk)] | chk) : ~usOcc;
+  if (CAPS) target &= themOcc;
+  if (QUIETS) target &= ~occAll;
+  const U64 pinned = king_blockers(us) & usOcc;
 
   // pawns
   U64 pawns = bb[us][PAWN];
@@ -90,25 +236,35 @@ void Position::gen_pseudo(MoveList& ml) const {
     int startRank = (us==WHITE) ? 1 : 6;
     int promoRank = (us==WHITE) ? 6 : 1;
     int to1 = from + dir;
+    // Pushes use the evasion mask without the capture/quiet filter applied to 'target'.
+    U64 pushMask = chk ? (ATK.between[ksq][ctz64(chk)] | chk) : ~0ULL;
+    if (pinned & sq_bb(from)) pushMask &= ATK.line[ksq][from];
+    if (QCHECKS) pushMask &= check_mask(from, checkSq[PAWN]);
 
-    if (to1 >= 0 && to1 < 64 && board[to1] == EMPTY_CODE) {
+    if (board[to1] == EMPTY_CODE) {
       if (r == promoRank) {
-        ml.push(make_move(from, to1, PAWN, NO_PIECE, QUEEN,  MF_PROMO));
-        ml.push(make_move(from, to1, PAWN, NO_PIECE, ROOK,   MF_PROMO));
-        ml.push(make_move(from, to1, PAWN, NO_PIECE, BISHOP, MF_PROMO));
-        ml.push(make_move(from, to1, PAWN, NO_PIECE, KNIGHT, MF_PROMO));
-      } else {
-        ml.push(make_move(from, to1, PAWN, NO_PIECE, NO_PIECE, MF_NONE));
+        if (!QUIETS && (pushMask & sq_bb(to1))) {
+          ml.push(make_move(from, to1, PAWN, NO_PIECE, QUEEN,  MF_PROMO));
+          ml.push(make_move(from, to1, PAWN, NO_PIECE, ROOK,   MF_PROMO));
+          ml.push(make_move(from, to1, PAWN, NO_PIECE, BISHOP, MF_PROMO));
+          ml.push(make_move(from, to1, PAWN, NO_PIECE, KNIGHT, MF_PROMO));
+        }
+      } else if (!CAPS) {
+        if (pushMask & sq_bb(to1)) ml.push(make_move(from, to1, PAWN, NO_PIECE, NO_PIECE, MF_NONE));
         if (r == startRank) {
           int to2 = from + 2*dir;
-          if (board[to2] == EMPTY_CODE) {
+          if (board[to2] == EMPTY_CODE && (pushMask & sq_bb(to2))) {
             ml.push(make_move(from, to2, PAWN, NO_PIECE, NO_PIECE, MF_DBLPAWN));
           }
         }
       }
     }
 
-    U64 caps = ATK.pawn[us][from] & themOcc;
+    if (QUIETS) continue;
+
+    U64 allowed = target;
+    if (pinned & sq_bb(from)) allowed &= ATK.line[ksq][from];
+    U64 caps = ATK.pawn[us][from] & themOcc & allowed;
     while (caps) {
       int to = pop_lsb(caps);
       Piece capP = code_piece(board[to]);
@@ -122,18 +278,22 @@ void Position::gen_pseudo(MoveList& ml) const {
       }
     }
 
-    if (epSq != NO_SQ) {
-      if (ATK.pawn[us][from] & sq_bb(epSq)) {
+    if (epSq != NO_SQ && (ATK.pawn[us][from] & sq_bb(epSq))) {
+      // En passant removes two pawns from one rank, so verify it on the resulting occupancy.
+      int capSq = (us == WHITE) ? (epSq - 8) : (epSq + 8);
+      U64 o = (occAll ^ sq_bb(from) ^ sq_bb(capSq)) | sq_bb(epSq);
+      if (!(attackers_to(ksq, o) & themOcc & ~sq_bb(capSq))) {
         ml.push(make_move(from, epSq, PAWN, PAWN, NO_PIECE, MF_EP));
       }
     }
   }
 
-  // knights
-  U64 knights = bb[us][KNIGHT];
+  // knights (a pinned knight can never move)
+  U64 knights = bb[us][KNIGHT] & ~pinned;
   while (knights) {
     int from = pop_lsb(knights);
-    U64 moves = ATK.knight[from] & ~usOcc;
+    U64 moves = ATK.knight[from] & target;
+    if (QCHECKS) moves &= check_mask(from, checkSq[KNIGHT]);
     while (moves) {
       int to = pop_lsb(moves);
       if (board[to] == EMPTY_CODE) ml.push(make_move(from,to,KNIGHT,NO_PIECE,NO_PIECE,MF_NONE));
@@ -145,7 +305,9 @@ void Position::gen_pseudo(MoveList& ml) const {
   U64 bishops = bb[us][BISHOP];
   while (bishops) {
     int from = pop_lsb(bishops);
-    U64 moves = bishop_attacks(from, occAll) & ~usOcc;
+    U64 moves = bishop_attacks(from, occAll) & target;
+    if (pinned & sq_bb(from)) moves &= ATK.line[ksq][from];
+    if (QCHECKS) moves &= check_mask(from, checkSq[BISHOP]);
     while (moves) {
       int to = pop_lsb(moves);
       if (board[to] == EMPTY_CODE) ml.push(make_move(from,to,BISHOP,NO_PIECE,NO_PIECE,MF_NONE));
@@ -157,7 +319,9 @@ void Position::gen_pseudo(MoveList& ml) const {
   U64 rooks = bb[us][ROOK];
   while (rooks) {
     int from = pop_lsb(rooks);
-    U64 moves = rook_attacks(from, occAll) & ~usOcc;
+    U64 moves = rook_attacks(from, occAll) & target;
+    if (pinned & sq_bb(from)) moves &= ATK.line[ksq][from];
+    if (QCHECKS) moves &= check_mask(from, checkSq[ROOK]);
     while (moves) {
       int to = pop_lsb(moves);
       if (board[to] == EMPTY_CODE) ml.push(make_move(from,to,ROOK,NO_PIECE,NO_PIECE,MF_NONE));
@@ -169,7 +333,9 @@ void Position::gen_pseudo(MoveList& ml) const {
   U64 queens = bb[us][QUEEN];
   while (queens) {
     int from = pop_lsb(queens);
-    U64 moves = (rook_attacks(from, occAll) | bishop_attacks(from, occAll)) & ~usOcc;
+    U64 moves = (rook_attacks(from, occAll) | bishop_attacks(from, occAll)) & target;
+    if (pinned & sq_bb(from)) moves &= ATK.line[ksq][from];
+    if (QCHECKS) moves &= check_mask(from, checkSq[QUEEN]);
     while (moves) {
       int to = pop_lsb(moves);
       if (board[to] == EMPTY_CODE) ml.push(make_move(from,to,QUEEN,NO_PIECE,NO_PIECE,MF_NONE));
@@ -177,37 +343,149 @@ void Position::gen_pseudo(MoveList& ml) const {
     }
   }
 
-  // king
-  {
-    int from = kingSq[us];
-    U64 moves = ATK.king[from] & ~usOcc;
-    while (moves) {
-      int to = pop_lsb(moves);
-      if (board[to] == EMPTY_CODE) ml.push(make_move(from,to,KING,NO_PIECE,NO_PIECE,MF_NONE));
-      else ml.push(make_move(from,to,KING,code_piece(board[to]),NO_PIECE,MF_NONE));
+  // castling (never out of check; through-squares not attacked)
+  if (CAPS || chk) return;
+
+  // A castle gives check only through the rook on its new square.
+  auto castle_checks = [&](int kFrom, int kTo, int rFrom, int rTo) {
+    if (!QCHECKS) return true;
+    U64 o = (occAll ^ sq_bb(kFrom) ^ sq_bb(rFrom)) | sq_bb(kTo) | sq_bb(rTo);
+    return (rook_attacks(rTo, o) & sq_bb(eksq)) != 0;
+  };
+
+  if (us == WHITE) {
+    if ((castling & WK) && board[5]==EMPTY_CODE && board[6]==EMPTY_CODE) {
+      if (!is_attacked(5, them) && !is_attacked(6, them) && castle_checks(4, 6, 7, 5))
+        ml.push(make_move(4,6,KING,NO_PIECE,NO_PIECE,MF_CASTLE));
+    }
+    if ((castling & WQ) && board[3]==EMPTY_CODE && board[2]==EMPTY_CODE && board[1]==EMPTY_CODE) {
+      if (!is_attacked(3, them) && !is_attacked(2, them) && castle_checks(4, 2, 0, 3))
+        ml.push(make_move(4,2,KING,NO_PIECE,NO_PIECE,MF_CASTLE));
     }
+  } else {
+    if ((castling & BK) && board[61]==EMPTY_CODE && board[62]==EMPTY_CODE) {
+      if (!is_attacked(61, them) && !is_attacked(62, them) && castle_checks(60, 62, 63, 61))
+        ml.push(make_move(60,62,KING,NO_PIECE,NO_PIECE,MF_CASTLE));
+    }
+    if ((castling & BQ) && board[59]==EMPTY_CODE && board[58]==EMPTY_CODE && board[57]==EMPTY_CODE) {
+      if (!is_attacked(59, them) && !is_attacked(58, them) && castle_checks(60, 58, 56, 59))
+        ml.push(make_move(60,58,KING,NO_PIECE,NO_PIECE,MF_CASTLE));
+    }
+  }
+}
 
-    // castling (needs through-squares not attacked)
-    if (us == WHITE) {
-      if ((castling & WK) && board[5]==EMPTY_CODE && board[6]==EMPTY_CODE) {
-        if (!is_attacked(4, them) && !is_attacked(5, them) && !is_attacked(6, them))
-          ml.push(make_move(4,6,KING,NO_PIECE,NO_PIECE,MF_CASTLE));
-      }
-      if ((castling & WQ) && board[3]==EMPTY_CODE && board[2]==EMPTY_CODE && board[1]==EMPTY_CODE) {
-        if (!is_attacked(4, them) && !is_attacked(3, them) && !is_attacked(2, them))
-          ml.push(make_move(4,2,KING,NO_PIECE,NO_PIECE,MF_CASTLE));
-      }
-    } else {
-      if ((castling & BK) && board[61]==EMPTY_CODE && board[62]==EMPTY_CODE) {
-        if (!is_attacked(60, them) && !is_attacked(61, them) && !is_attacked(62, them))
-          ml.push(make_move(60,62,KING,NO_PIECE,NO_PIECE,MF_CASTLE));
-      }
-      if ((castling & BQ) && board[59]==EMPTY_CODE && board[58]==EMPTY_CODE && board[57]==EMPTY_CODE) {
-        if (!is_attacked(60, them) && !is_attacked(59, them) && !is_attacked(58, them))
-          ml.push(make_move(60,58,KING,NO_PIECE,NO_PIECE,MF_CASTLE));
-      }
+void Position::gen_legal(MoveList& ml) const { generate<GEN_LEGAL>(ml); }
+void Position::gen_captures(MoveList& ml) const { generate<GEN_CAPTURES>(ml); }
+void Position::gen_quiets(MoveList& ml) const { generate<GEN_QUIETS>(ml); }
+void Position::gen_quiet_checks(MoveList& ml) const { generate<GEN_QUIET_CHECKS>(ml); }
+void Position::gen_evasions(MoveList& ml) const { generate<GEN_EVASIONS>(ml); }
+
+bool Position::is_pseudo_legal(Move m) const {
+  if (m == 0) return false;
+  const int from = m_from(m);
+  const int to   = m_to(m);
+  const Piece p  = m_piece(m);
+  const Piece cap= m_cap(m);
+  const Piece promo = m_promo(m);
+  const uint8_t flags = m_flags(m);
+  const Color us = stm;
+  const Color them = !stm;
+
+  if (p > KING || board[from] != code(us, p)) return false;
+
+  // Castling has several preconditions; defer to the generator (rare for TT/killer moves).
+  if (flags & MF_CASTLE) {
+    MoveList ml;
+    gen_legal(ml);
+    for (int i = 0; i < ml.size; i++) if (ml.moves[i] == m) return true;
+    return false;
+  }
+
+  // Destination must hold exactly the piece encoded as captured.
+  if (flags & MF_EP) {
+    return p == PAWN && cap == PAWN && to == epSq && promo == NO_PIECE && flags == MF_EP
+        && (ATK.pawn[us][from] & sq_bb(to));
+  }
+  if (cap == NO_PIECE) {
+    if (board[to] != EMPTY_CODE) return false;
+  } else {
+    if (cap == KING || board[to] != code(them, cap)) return false;
+  }
+
+  if (p == PAWN) {
+    const int dir = (us == WHITE) ? 8 : -8;
+    const bool lastRank = (us == WHITE) ? (rank_of(to) == 7) : (rank_of(to) == 0);
+    if (lastRank != ((flags & MF_PROMO) != 0)) return false;
+    if (flags & MF_PROMO) {
+      if (promo < KNIGHT || promo > QUEEN || (flags & ~MF_PROMO)) return false;
+    } else if (promo != NO_PIECE) {
+      return false;
     }
+    if (cap != NO_PIECE) return (flags & MF_DBLPAWN) == 0 && (ATK.pawn[us][from] & sq_bb(to));
+    if (to == from + dir) return (flags & MF_DBLPAWN) == 0;
+    const int startRank = (us == WHITE) ? 1 : 6;
+    return flags == MF_DBLPAWN && rank_of(from) == startRank && to == from + 2*dir
+        && board[from + dir] == EMPTY_CODE;
+  }
+
+  if (flags != MF_NONE || promo != NO_PIECE) return false;
+  U64 att = 0;
+  switch (p) {
+    case KNIGHT: att = ATK.knight[from]; break;
+    case BISHOP: att = bishop_attacks(from, occAll); break;
+    case ROOK:   att = rook_attacks(from, occAll); break;
+    case QUEEN:  att = bishop_attacks(from, occAll) | rook_attacks(from, occAll); break;
+    case KING:   att = ATK.king[from]; break;
+    default: break;
+  }
+  return (att & sq_bb(to)) != 0;
+}
+
+Move Position::move_from_compact(uint16_t cm) const {
+  if (cm == 0) return 0;
+  const int from = cm & 63;
+  const int to = (cm >> 6) & 63;
+  const Piece promo = (Piece)((cm >> 12) & 7);
+  if (board[from] == EMPTY_CODE) return 0;
+  const Piece p = code_piece(board[from]);
+  Piece cap = (board[to] == EMPTY_CODE) ? NO_PIECE : code_piece(board[to]);
+  uint8_t flags = MF_NONE;
+
+  if (p == PAWN) {
+    if (to == epSq && cap == NO_PIECE && file_of(to) != file_of(from)) { cap = PAWN; flags |= MF_EP; }
+    if (to - from == 16 || from - to == 16) flags |= MF_DBLPAWN;
+    if (promo != PAWN) flags |= MF_PROMO;
+  } else if (p == KING && (to - from == 2 || from - to == 2)) {
+    flags |= MF_CASTLE;
+  }
+  return make_move(from, to, p, cap, (flags & MF_PROMO) ? promo : NO_PIECE, flags);
+}
+
+bool Position::is_legal(Move m) const {
+  if (!is_pseudo_legal(m)) return false;
+  if (m_flags(m) & MF_CASTLE) return true; // validated against the legal generator
+
+  const int from = m_from(m);
+  const int to   = m_to(m);
+  const Color us = stm;
+  const Color them = !stm;
+  const int ksq = kingSq[us];
+
+  if (m_piece(m) == KING) return !(attackers_to(to, occAll ^ sq_bb(from)) & occ[them]);
+
+  if (m_flags(m) & MF_EP) {
+    int capSq = (us == WHITE) ? (to - 8) : (to + 8);
+    U64 o = (occAll ^ sq_bb(from) ^ sq_bb(capSq)) | sq_bb(to);
+    return !(attackers_to(ksq, o) & occ[them] & ~sq_bb(capSq));
   }
+
+  const U64 chk = checkers();
+  if (chk) {
+    if (chk & (chk - 1)) return false;
+    if (!((ATK.between[ksq][ctz64(chk)] | chk) & sq_bb(to))) return false;
+  }
+  if (king_blockers(us) & sq_bb(from)) return (ATK.line[ksq][from] & sq_bb(to)) != 0;
+  return true;
 }
 
 void Position::make(Move m, Undo& u) {
@@ -218,8 +496,8 @@ void Position::make(Move m, Undo& u) {
   u.pawnKey = pawnKey;
   u.occ[0] = occ[0];
   u.occ[1] = occ[1];
-  u.halfmoveClock = halfmoveClock;
-  u.fullmoveNumber = fullmoveNumber;
+  u.psq = psq;
+  u.phase = phase;
   u.halfmoveClock = halfmoveClock;
   u.fullmoveNumber = fullmoveNumber;
 
@@ -248,6 +526,8 @@ void Position::make(Move m, Undo& u) {
     key ^= ZP[u.capturedCode][to];
     if (cap == PAWN) pawnKey ^= ZP[u.capturedCode][to];
     occ[them] ^= sq_bb(to);
+    psq -= PSQ[u.capturedCode][to];
+    phase -= PHASE_BY_CODE[u.capturedCode];
 
     // If a rook was captured on its home square, clear the corresponding castling right.
     if (cap == ROOK) {
@@ -264,6 +544,7 @@ void Position::make(Move m, Undo& u) {
   key ^= ZP[code(us,p)][from];
   if (p == PAWN) pawnKey ^= ZP[code(us,PAWN)][from];
   occ[us] ^= sq_bb(from);
+  psq -= PSQ[code(us,p)][from];
 
   if (flags & MF_EP) {
     int capSq = (us == WHITE) ? (to - 8) : (to + 8);
@@ -274,6 +555,7 @@ void Position::make(Move m, Undo& u) {
     key ^= ZP[u.capturedCode][capSq];
     pawnKey ^= ZP[u.capturedCode][capSq];
     occ[them] ^= sq_bb(capSq);
+    psq -= PSQ[u.capturedCode][capSq];
   }
 
   if (flags & MF_CASTLE) {
@@ -283,12 +565,14 @@ void Position::make(Move m, Undo& u) {
         board[7] = EMPTY_CODE; board[5] = code(WHITE, ROOK);
 
         key ^= ZP[code(WHITE,ROOK)][7] ^ ZP[code(WHITE,ROOK)][5];
+        psq += PSQ[code(WHITE,ROOK)][5] - PSQ[code(WHITE,ROOK)][7];
         occ[WHITE] ^= sq_bb(7) ^ sq_bb(5);
       } else { // a1->d1
         bb[WHITE][ROOK] ^= sq_bb(0); bb[WHITE][ROOK] ^= sq_bb(3);
         board[0] = EMPTY_CODE; board[3] = code(WHITE, ROOK);
 
         key ^= ZP[code(WHITE,ROOK)][0] ^ ZP[code(WHITE,ROOK)][3];
+        psq += PSQ[code(WHITE,ROOK)][3] - PSQ[code(WHITE,ROOK)][0];
         occ[WHITE] ^= sq_bb(0) ^ sq_bb(3);
       }
     } else {
@@ -297,12 +581,14 @@ void Position::make(Move m, Undo& u) {
         board[63] = EMPTY_CODE; board[61] = code(BLACK, ROOK);
 
         key ^= ZP[code(BLACK,ROOK)][63] ^ ZP[code(BLACK,ROOK)][61];
+        psq += PSQ[code(BLACK,ROOK)][61] - PSQ[code(BLACK,ROOK)][63];
         occ[BLACK] ^= sq_bb(63) ^ sq_bb(61);
       } else { // a8->d8
         bb[BLACK][ROOK] ^= sq_bb(56); bb[BLACK][ROOK] ^= sq_bb(59);
         board[56] = EMPTY_CODE; board[59] = code(BLACK, ROOK);
 
         key ^= ZP[code(BLACK,ROOK)][56] ^ ZP[code(BLACK,ROOK)][59];
+        psq += PSQ[code(BLACK,ROOK)][59] - PSQ[code(BLACK,ROOK)][56];
         occ[BLACK] ^= sq_bb(56) ^ sq_bb(59);
       }
     }
@@ -314,6 +600,8 @@ void Position::make(Move m, Undo& u) {
 
     key ^= ZP[code(us,promo)][to];
     occ[us] ^= sq_bb(to);
+    psq += PSQ[code(us,promo)][to];
+    phase += PHASE_INC[promo];
   } else {
     bb[us][p] ^= sq_bb(to);
     board[to] = code(us, p);
@@ -321,6 +609,7 @@ void Position::make(Move m, Undo& u) {
     key ^= ZP[code(us,p)][to];
     if (p == PAWN) pawnKey ^= ZP[code(us,PAWN)][to];
     occ[us] ^= sq_bb(to);
+    psq += PSQ[code(us,p)][to];
   }
 
   if (p == KING) {
@@ -356,6 +645,8 @@ void Position::make(Move m, Undo& u) {
   if (stm == WHITE) fullmoveNumber++;
 
   occAll = occ[WHITE] | occ[BLACK];
+
+  if (accStack) accStack->push(++accTop, m, u.capturedCode, us);
 }
 
 void Position::unmake(Move m, const Undo& u) {
@@ -376,6 +667,8 @@ void Position::unmake(Move m, const Undo& u) {
   pawnKey = u.pawnKey;
   occ[0] = u.occ[0];
   occ[1] = u.occ[1];
+  psq = u.psq;
+  phase = u.phase;
   halfmoveClock = u.halfmoveClock;
   fullmoveNumber = u.fullmoveNumber;
 
@@ -427,6 +720,8 @@ void Position::unmake(Move m, const Undo& u) {
 
   (void)cap;
   occAll = occ[WHITE] | occ[BLACK];
+
+  if (accStack) accTop--;
 }
 
 void Position::make_null(Undo& u) {
@@ -437,6 +732,8 @@ void Position::make_null(Undo& u) {
   u.pawnKey = pawnKey;
   u.occ[0] = occ[0];
   u.occ[1] = occ[1];
+  u.psq = psq;
+  u.phase = phase;
   u.halfmoveClock = halfmoveClock;
   u.fullmoveNumber = fullmoveNumber;
 
@@ -462,6 +759,8 @@ void Position::unmake_null(const Undo& u) {
   pawnKey = u.pawnKey;
   occ[0] = u.occ[0];
   occ[1] = u.occ[1];
+  psq = u.psq;
+  phase = u.phase;
   halfmoveClock = u.halfmoveClock;
   fullmoveNumber = u.fullmoveNumber;
   stm = !stm;
@@ -5,12 +5,18 @@
 #include "types.h"
 #include "move.h"
 #include "movelist.h"
+#include "psqt.h"
+
+namespace nnue { struct AccStack; }
 
 constexpr int EMPTY_CODE = 12; // board[] entry for empty
 
 inline int code(Color c, Piece p) { return (int)c*6 + (int)p; }
 inline Piece code_piece(int c) { return (Piece)(c % 6); }
 
+// Move subsets produced by Position::generate().
+enum GenType : int { GEN_LEGAL=0, GEN_CAPTURES=1, GEN_QUIETS=2, GEN_QUIET_CHECKS=3, GEN_EVASIONS=4 };
+
 
 struct Undo {
   uint8_t castling;
@@ -19,10 +25,25 @@ struct Undo {
   U64 key;
   U64 pawnKey;
   U64 occ[2];
+  Score psq;
+  int phase;
   uint16_t halfmoveClock;
   uint16_t fullmoveNumber;
 };
 
+struct Position;
+
+// Per-node data for fast "does this move give check" tests: for each piece type the
+// squares from which it would attack the enemy king, and our pieces whose departure
+// from the line to that king uncovers a slider (discovered-check candidates).
+struct CheckInfo {
+  U64 checkSq[6];
+  U64 dcCandidates;
+  int ksq;
+
+  explicit CheckInfo(const Position& pos);
+};
+
 struct Position {
   U64 bb[2][6]{};
   U64 occ[2]{};
@@ -34,6 +55,15 @@ struct Position {
   // Incremental pawn-only Zobrist key (for pawn hash)
   U64 pawnKey = 0;
 
+  // Incremental material + PST (packed mg/eg, White's view) and game phase (unclamped)
+  Score psq = 0;
+  int phase = 0;
+
+  // NNUE first-layer stack of the searching thread (null unless attached, see nnue.h);
+  // make/unmake push and pop accTop.
+  nnue::AccStack* accStack = nullptr;
+  int accTop = 0;
+
   int board[64];
   Color stm = WHITE;
   uint8_t castling = 0;
@@ -52,9 +82,43 @@ struct Position {
   void rebuild_occ();
   void rebuild_key();
   void rebuild_pawn_key();
+  void rebuild_psq();
   bool is_attacked(int sq, Color by) const;
 
-  void gen_pseudo(MoveList& ml) const;
+  // Pieces of both colors attacking 'sq' given occupancy 'occupied'.
+  U64 attackers_to(int sq, U64 occupied) const;
+  // Enemy pieces giving check to the side to move.
+  U64 checkers() const;
+  // Pieces (either color) that are the only blocker between c's king and an enemy slider.
+  U64 king_blockers(Color c) const;
+
+  // Fully legal move generation: checkers and pins are computed once, so every
+  // emitted move can be made without a follow-up is_attacked() test.
+  void gen_legal(MoveList& ml) const;
+
+  // Legal subsets for staged/quiescence search:
+  // captures (incl. en passant) and all promotions,
+  void gen_captures(MoveList& ml) const;
+  // the remaining non-capture, non-promotion moves,
+  void gen_quiets(MoveList& ml) const;
+  // non-capture, non-promotion moves giving direct or discovered check (not in check),
+  void gen_quiet_checks(MoveList& ml) const;
+  // and all legal replies when the side to move is in check.
+  void gen_evasions(MoveList& ml) const;
+
+  template <int Type> void generate(MoveList& ml) const;
+
+  // Validate a move that did not come from the generator (TT move, killers):
+  // is_pseudo_legal() checks it matches the board, is_legal() also checks king safety.
+  bool is_pseudo_legal(Move m) const;
+  bool is_legal(Move m) const;
+  // Full move for a compact_move() on this board (0 if the from-square is empty);
+  // the result still needs is_legal().
+  Move move_from_compact(uint16_t cm) const;
+
+  // Whether a legal move checks the opponent, without make/unmake.
+  bool gives_check(Move m, const CheckInfo& ci) const;
+  bool gives_check(Move m) const { return gives_check(m, CheckInfo(*this)); }
 
 
   // Repetition helpers (game history)
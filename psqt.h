@@ -0,0 +1,179 @@
+#pragma once
+#include <cstdint>
+#include "types.h"
+
+// Material and piece-square tables of the classical eval, plus the phase weights.
+// PSTs are from White's point of view (a1 = 0); black squares are mirrored with sq ^ 56.
+
+// Tapered material values
+inline constexpr int MG_VAL[6] = { 82, 337, 365, 477, 1025, 0 };
+inline constexpr int EG_VAL[6] = { 94, 281, 297, 512,  936, 0 };
+
+// Phase increments (how much each piece contributes to "middlegame-ness")
+inline constexpr int PHASE_INC[6] = {0, 1, 1, 2, 4, 0};
+inline constexpr int TOTAL_PHASE = 24;
+
+// ------------------------------------------------------------
+// PSTs
+// ------------------------------------------------------------
+inline constexpr int PST_P_MG[64] = {
+   0,  0,  0,  0,  0,  0,  0,  0,
+  10, 12,  6, -5, -5,  6, 12, 10,
+   4,  4,  2,  8,  8,  2,  4,  4,
+   2,  2,  6, 14, 14,  6,  2,  2,
+   2,  4,  8, 18, 18,  8,  4,  2,
+   4,  6, 10,  0,  0, 10,  6,  4,
+  40, 40, 40, 40, 40, 40, 40, 40,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+
+inline constexpr int PST_P_EG[64] = {
+   0,  0,  0,  0,  0,  0,  0,  0,
+  20, 18, 16, 14, 14, 16, 18, 20,
+  12, 12, 12, 12, 12, 12, 12, 12,
+   8, 10, 12, 14, 14, 12, 10,  8,
+   6,  8, 10, 12, 12, 10,  8,  6,
+   4,  6,  8, 10, 10,  8,  6,  4,
+   2,  2,  2,  2,  2,  2,  2,  2,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+
+inline constexpr int PST_N_MG[64] = {
+ -50,-40,-30,-30,-30,-30,-40,-50,
+ -40,-20,  0,  0,  0,  0,-20,-40,
+ -30,  0, 10, 15, 15, 10,  0,-30,
+ -30,  5, 15, 20, 20, 15,  5,-30,
+ -30,  0, 15, 20, 20, 15,  0,-30,
+ -30,  5, 10, 15, 15, 10,  5,-30,
+ -40,-20,  0,  5,  5,  0,-20,-40,
+ -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+inline constexpr int PST_N_EG[64] = {
+ -40,-30,-20,-20,-20,-20,-30,-40,
+ -30,-10,  0,  0,  0,  0,-10,-30,
+ -20,  0, 10, 12, 12, 10,  0,-20,
+ -20,  5, 12, 18, 18, 12,  5,-20,
+ -20,  0, 12, 18, 18, 12,  0,-20,
+ -20,  5, 10, 12, 12, 10,  5,-20,
+ -30,-10,  0,  5,  5,  0,-10,-30,
+ -40,-30,-20,-20,-20,-20,-30,-40
+};
+
+inline constexpr int PST_B_MG[64] = {
+ -20,-10,-10,-10,-10,-10,-10,-20,
+ -10,  0,  0,  0,  0,  0,  0,-10,
+ -10,  0,  5, 10, 10,  5,  0,-10,
+ -10,  5,  5, 10, 10,  5,  5,-10,
+ -10,  0, 10, 10, 10, 10,  0,-10,
+ -10, 10, 10, 10, 10, 10, 10,-10,
+ -10,  5,  0,  0,  0,  0,  5,-10,
+ -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+inline constexpr int PST_B_EG[64] = {
+ -15,-10,-10,-10,-10,-10,-10,-15,
+ -10,  0,  0,  0,  0,  0,  0,-10,
+ -10,  0,  8, 10, 10,  8,  0,-10,
+ -10,  8, 10, 12, 12, 10,  8,-10,
+ -10,  0, 10, 12, 12, 10,  0,-10,
+ -10, 10, 10, 10, 10, 10, 10,-10,
+ -10,  5,  0,  0,  0,  0,  5,-10,
+ -15,-10,-10,-10,-10,-10,-10,-15
+};
+
+inline constexpr int PST_R_MG[64] = {
+   0,  0,  5, 10, 10,  5,  0,  0,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+   5, 10, 10, 10, 10, 10, 10,  5,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+
+inline constexpr int PST_R_EG[64] = {
+   0,  0,  5,  8,  8,  5,  0,  0,
+   0,  0,  0,  2,  2,  0,  0,  0,
+   0,  0,  0,  2,  2,  0,  0,  0,
+   0,  0,  0,  2,  2,  0,  0,  0,
+   0,  0,  0,  2,  2,  0,  0,  0,
+   0,  0,  0,  2,  2,  0,  0,  0,
+   5,  8,  8, 10, 10,  8,  8,  5,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+
+inline constexpr int PST_Q_MG[64] = {
+ -20,-10,-10, -5, -5,-10,-10,-20,
+ -10,  0,  0,  0,  0,  0,  0,-10,
+ -10,  0,  5,  5,  5,  5,  0,-10,
+  -5,  0,  5,  5,  5,  5,  0, -5,
+   0,  0,  5,  5,  5,  5,  0, -5,
+ -10,  5,  5,  5,  5,  5,  0,-10,
+ -10,  0,  5,  0,  0,  0,  0,-10,
+ -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+inline constexpr int PST_Q_EG[64] = {
+ -10, -5, -5, -2, -2, -5, -5,-10,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  5,  5,  5,  5,  0, -5,
+  -2,  0,  5,  6,  6,  5,  0, -2,
+  -2,  0,  5,  6,  6,  5,  0, -2,
+  -5,  0,  5,  5,  5,  5,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+ -10, -5, -5, -2, -2, -5, -5,-10
+};
+
+inline constexpr int PST_K_MG[64] = {
+ -50,-40,-30,-20,-20,-30,-40,-50,
+ -40,-30,-20,-10,-10,-20,-30,-40,
+ -30,-20,-10,  0,  0,-10,-20,-30,
+ -20,-10,  0, 10, 10,  0,-10,-20,
+ -20,-10,  0, 10, 10,  0,-10,-20,
+ -30,-20,-10,  0,  0,-10,-20,-30,
+ -40,-30,-20,-10,-10,-20,-30,-40,
+ -50,-40,-30,-20,-20,-30,-40,-50
+};
+
+inline constexpr int PST_K_EG[64] = {
+ -20,-10,-10,-10,-10,-10,-10,-20,
+ -10,  0,  0,  0,  0,  0,  0,-10,
+ -10,  0, 10, 10, 10, 10,  0,-10,
+ -10,  0, 10, 20, 20, 10,  0,-10,
+ -10,  0, 10, 20, 20, 10,  0,-10,
+ -10,  0, 10, 10, 10, 10,  0,-10,
+ -10,  0,  0,  0,  0,  0,  0,-10,
+ -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+// Packed mg/eg score: eg in the upper 16 bits, mg in the lower (signed) 16 bits, so
+// one add/sub updates both halves.
+using Score = int32_t;
+constexpr Score make_score(int mg, int eg) { return (Score)((uint32_t)eg << 16) + mg; }
+constexpr int mg_value(Score s) { return (int16_t)(uint16_t)(uint32_t)s; }
+constexpr int eg_value(Score s) { return (int16_t)(uint16_t)((uint32_t)(s + 0x8000) >> 16); }
+
+// Material + PST per piece code (c*6 + p) and square, from White's point of view.
+struct PsqTable {
+  Score psq[12][64]{};
+};
+
+constexpr PsqTable make_psq_table() {
+  const int* mgPst[6] = { PST_P_MG, PST_N_MG, PST_B_MG, PST_R_MG, PST_Q_MG, PST_K_MG };
+  const int* egPst[6] = { PST_P_EG, PST_N_EG, PST_B_EG, PST_R_EG, PST_Q_EG, PST_K_EG };
+  PsqTable t{};
+  for (int p=0; p<6; p++)
+    for (int sq=0; sq<64; sq++) {
+      t.psq[p][sq]     =  make_score(MG_VAL[p] + mgPst[p][sq],      EG_VAL[p] + egPst[p][sq]);
+      t.psq[6 + p][sq] = -make_score(MG_VAL[p] + mgPst[p][sq ^ 56], EG_VAL[p] + egPst[p][sq ^ 56]);
+    }
+  return t;
+}
+
+inline constexpr PsqTable PSQT = make_psq_table();
+inline constexpr const Score (&PSQ)[12][64] = PSQT.psq;
+
+// Phase contribution per piece code.
+inline constexpr int PHASE_BY_CODE[12] = { 0, 1, 1, 2, 4, 0, 0, 1, 1, 2, 4, 0 };
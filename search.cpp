@@ -1,6 +1,8 @@
 #include "search.h"
 #include "eval.h"
 #include "movelist.h"
+#include "movepick.h"
+#include "nnue.h"
 #include "see.h"
 #include "syzygy.h"
 #include "params.h"
@@ -11,8 +13,10 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <unordered_map>
 
 static std::string move_to_uci_local(Move m) {
   auto sq_to = [](int sq)->std::string{
@@ -35,47 +39,45 @@ static std::string move_to_uci_local(Move m) {
   return s;
 }
 
-static bool is_legal(Position& pos, Move m) {
-  Undo u;
-  Color us = pos.stm;
-  pos.make(m, u);
-  bool legal = !pos.is_attacked(pos.kingSq[us], !us);
-  pos.unmake(m, u);
-  return legal;
+static bool is_search_move(const Searcher& S, Move m) {
+  return S.searchMoves.empty() || std::find(S.searchMoves.begin(), S.searchMoves.end(), m) != S.searchMoves.end();
 }
 
-// Follow TT best moves to build a principal variation. This keeps PV generation
-// lightweight (no PV arrays in the search stack) and robust to TT collisions.
-static std::string build_pv(Position pos, Searcher& S, Move firstMove, int maxLen = 32) {
-  std::vector<std::string> pv;
-  pv.reserve(maxLen);
-
-  // Track visited keys to avoid endless loops on TT collisions.
-  std::vector<uint64_t> seen;
-  seen.reserve(maxLen + 2);
-  seen.push_back(pos.key);
-
-  Move m = firstMove;
-  for (int i = 0; i < maxLen && m != 0; i++) {
-    if (!is_legal(pos, m)) break;
+// Move to play when no iteration finished (stopped inside depth 1): the TT move if it is
+// usable, else a one-ply scan the stop flag cannot cut short: static eval after the move,
+// less the opponent's best capture by SEE, so it does not hang material.
+static Move fallback_move(const Searcher& S, Position& pos) {
+  TTEntry tte;
+  if (S.tt.probe(pos.key, tte)) {
+    const Move m = pos.move_from_compact(tte.move);
+    if (m && pos.is_legal(m) && is_search_move(S, m)) return m;
+  }
 
+  MoveList ml;
+  pos.gen_legal(ml);
+  Move best = 0;
+  int bestScore = -SCORE_INF;
+  for (int i = 0; i < ml.size; i++) {
+    const Move m = ml.moves[i];
+    if (!is_search_move(S, m)) continue;
     Undo u;
     pos.make(m, u);
-    pv.push_back(move_to_uci_local(m));
-
-    // Break on repetition/cycle in PV.
-    if (std::find(seen.begin(), seen.end(), pos.key) != seen.end()) break;
-    seen.push_back(pos.key);
-
-    TTEntry tte;
-    if (!S.tt.probe(pos.key, tte) || tte.bestMove == 0) break;
-    m = (Move)tte.bestMove;
+    MoveList caps;
+    pos.gen_captures(caps);
+    int threat = 0;
+    for (int j = 0; j < caps.size; j++) threat = std::max(threat, see(pos, caps.moves[j]));
+    const int score = -(eval(pos) + threat);
+    pos.unmake(m, u);
+    if (score > bestScore) { bestScore = score; best = m; }
   }
+  return best;
+}
 
+static std::string pv_to_string(const std::vector<Move>& pv) {
   std::string out;
   for (size_t i = 0; i < pv.size(); i++) {
     if (i) out.push_back(' ');
-    out += pv[i];
+    out += move_to_uci_local(pv[i]);
   }
   return out;
 }
@@ -83,9 +85,6 @@ static std::string build_pv(Position pos, Searcher& S, Move firstMove, int maxLe
 static constexpr int INF  = SCORE_INF;
 static constexpr int MATE = SCORE_MATE;
 
-static inline bool is_capture(Move m) { return m_cap(m) != NO_PIECE || (m_flags(m) & MF_EP); }
-static inline bool is_promo(Move m)   { return (m_flags(m) & MF_PROMO) != 0; }
-
 static inline int piece_value(Piece p) {
   switch (p) {
     case PAWN: return 100;
@@ -130,7 +129,7 @@ Move parse_uci_move(Position& pos, const std::string& uci) {
   }
 
   MoveList ml;
-  pos.gen_pseudo(ml);
+  pos.gen_legal(ml);
   for (int i=0;i<ml.size;i++) {
     Move m = ml.moves[i];
     if (m_from(m) != from || m_to(m) != to) continue;
@@ -140,13 +139,6 @@ Move parse_uci_move(Position& pos, const std::string& uci) {
     } else {
       if (m_flags(m) & MF_PROMO) continue;
     }
-    // legality
-    Undo u;
-    Color us = pos.stm;
-    pos.make(m,u);
-    bool legal = !pos.is_attacked(pos.kingSq[us], !us);
-    pos.unmake(m,u);
-    if (!legal) continue;
     return m;
   }
   return 0;
@@ -203,6 +195,8 @@ void Searcher::set_threads(int n) {
   if (n < 1) n = 1;
   if (n > 64) n = 64;
   threads = n;
+  helpers.resize(threads - 1);
+  stats = std::make_unique<ThreadStats[]>((size_t)threads);
   heurByThread.resize((size_t)threads);
   // Don't wipe mid-game when resizing; but new threads should start clean.
   for (auto& h : heurByThread) {
@@ -218,7 +212,72 @@ void Searcher::clear() {
   for (auto& h : heurByThread) h.clear();
 }
 
-void Searcher::stop() { stopFlag.store(true); }
+void Searcher::stop() {
+  std::lock_guard<std::mutex> lk(ponderMutex);
+  stopFlag.store(true);
+  ponderCv.notify_all();
+}
+
+void Searcher::ponderhit() {
+  std::lock_guard<std::mutex> lk(ponderMutex);
+  if (!pondering.load()) return;
+  pondering.store(false);
+  // If go() has not set up its budget yet it will arm the timer itself.
+  if (searchActive && tm.hard_ms() > 0)
+    start_timer(tm.start_time() + std::chrono::milliseconds(tm.hard_ms()));
+  ponderCv.notify_all();
+}
+
+Searcher::SearchTotals Searcher::totals() const {
+  SearchTotals t;
+  for (int i = 0; i < threads; i++) {
+    t.nodes  += stats[i].nodes.load(std::memory_order_relaxed);
+    t.qnodes += stats[i].qnodes.load(std::memory_order_relaxed);
+    t.tbhits += stats[i].tbhits.load(std::memory_order_relaxed);
+    t.ttHits += stats[i].ttHits.load(std::memory_order_relaxed);
+  }
+  return t;
+}
+
+void Searcher::clear_stats() {
+  for (int i = 0; i < threads; i++) {
+    stats[i].nodes.store(0, std::memory_order_relaxed);
+    stats[i].qnodes.store(0, std::memory_order_relaxed);
+    stats[i].tbhits.store(0, std::memory_order_relaxed);
+    stats[i].ttHits.store(0, std::memory_order_relaxed);
+  }
+}
+
+void Searcher::start_timer(std::chrono::steady_clock::time_point deadline) {
+  {
+    std::lock_guard<std::mutex> lk(timerMutex);
+    timerCancel = false;
+  }
+  timerThread.run(0, [this, deadline] {
+    std::unique_lock<std::mutex> lk(timerMutex);
+    if (timerCv.wait_until(lk, deadline, [this] { return timerCancel; })) return;
+    // Deadline passed: stop as soon as there is a move to play.
+    timerCv.wait(lk, [this] { return timerCancel || timerRootReady; });
+    if (!timerCancel) stopFlag.store(true, std::memory_order_relaxed);
+  });
+}
+
+void Searcher::timer_root_ready(bool ready) {
+  {
+    std::lock_guard<std::mutex> lk(timerMutex);
+    timerRootReady = ready;
+  }
+  timerCv.notify_all();
+}
+
+void Searcher::stop_timer() {
+  {
+    std::lock_guard<std::mutex> lk(timerMutex);
+    timerCancel = true;
+  }
+  timerCv.notify_all();
+  timerThread.wait(0);
+}
 
 void Searcher::tt_resize_mb(int mb) { tt.resize_mb(mb); }
 
@@ -284,47 +343,6 @@ static inline bool has_non_pawn_material(const Position& pos, Color c) {
   return (pos.bb[c][KNIGHT] | pos.bb[c][BISHOP] | pos.bb[c][ROOK] | pos.bb[c][QUEEN]) != 0;
 }
 
-static inline int move_score_basic(const Searcher::Heuristics& H, const Position& pos, Move m, Move ttMove, Move prevMove, int ply) {
-  if (m == ttMove) return 10'000'000;
-  if (is_capture(m) || is_promo(m)) {
-    int victim = (m_flags(m) & MF_EP) ? PAWN : m_cap(m);
-    int attacker = m_piece(m);
-    // MVV-LVA style score (fast). We avoid doing full SEE here because this
-    // function is called for *every* pseudo move at *every* node.
-    int score = 5'000'000 + 1000 * (victim + 1) - attacker;
-    // Capture history bonus (learns which captures tend to work)
-    score += H.captureHist[attacker][m_to(m)][victim] * 4;
-
-    // Promotions are very forcing; prioritize them heavily.
-    if (is_promo(m)) {
-      // m_promo() is the promoted piece type (KNIGHT..QUEEN)
-      score += 400'000 + 50'000 * (int)m_promo(m);
-    }
-
-    // Recapture bonus: if responding to a capture on the same square, prioritize it.
-    if (prevMove && is_capture(prevMove) && m_to(m) == m_to(prevMove)) score += 60'000;
-    return score;
-  }
-  if (m == H.killers[ply][0]) return 4'000'000;
-  if (m == H.killers[ply][1]) return 3'900'000;
-
-  if (prevMove) {
-    Move cm = H.countermove[pos.stm][m_from(prevMove)][m_to(prevMove)];
-    if (m == cm) return 3'800'000;
-  }
-
-  int score = 0;
-  score += H.history[pos.stm][m_from(m)][m_to(m)];
-  if (prevMove) {
-    int pp = m_piece(prevMove);
-    int pto = m_to(prevMove);
-    int p = m_piece(m);
-    int to = m_to(m);
-    score += H.contHist[pos.stm][pp][pto][p][to] / 2;
-  }
-  return score;
-}
-
 static inline void sort_moves(std::vector<std::pair<int,Move>>& v) {
   std::sort(v.begin(), v.end(), [](auto& a, auto& b){ return a.first > b.first; });
 }
@@ -362,26 +380,82 @@ struct SearchContext {
   Searcher::Heuristics* H = nullptr;
   bool allowSyzygy = true;
   std::chrono::steady_clock::time_point start;
-  // Hard and soft time limits (ms since start).
-  // Hard limit is used by time_up() and must never be exceeded.
-  // Soft limit is used to decide whether to start another iteration.
-  int hardLimitMs = 0;
-  int softLimitMs = 0;
-  int64_t nodes = 0;
-  uint32_t timeCheck = 0; // for cheap periodic time checks
+  Searcher::ThreadStats* stats = nullptr; // this thread's counter slot
+  TimeManager* tm = nullptr;              // set where root-move effort is recorded
   int selDepth = 0;
   StackFrame stack[Searcher::MAX_PLY+1]{};
   uint64_t keyStack[Searcher::MAX_PLY+1]{};
   int rootHistoryLen = 0;
+  bool abdada = false; // defer moves other threads are searching (SMP_ABDADA)
+  // Triangular PV table: pv[ply][ply .. pvLen[ply]) is the best line found from ply on.
+  Move pv[Searcher::MAX_PLY+1][Searcher::MAX_PLY+1];
+  int pvLen[Searcher::MAX_PLY+1]{};
+  // MultiPV: root moves already reported as earlier lines of this iteration.
+  std::vector<Move> rootExcluded;
+  // NNUE accumulators of this thread's line (only while a network is loaded).
+  std::unique_ptr<nnue::AccStack> acc;
 };
 
-static inline bool time_up(SearchContext& ctx) {
-  if (ctx.hardLimitMs <= 0) return false;
-  // Checking the clock at every node is expensive. Poll periodically.
-  if ((ctx.timeCheck++ & 2047u) != 0) return false; // ~every 2048 nodes
-  auto now = std::chrono::steady_clock::now();
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - ctx.start).count();
-  return ms >= ctx.hardLimitMs;
+// Point pos (this thread's copy of the root) at the context's accumulator stack.
+static void attach_nnue(SearchContext& ctx, Position& pos) {
+  if (!nnue::enabled()) { nnue::attach(pos, nullptr); return; }
+  if (!ctx.acc) ctx.acc = std::make_unique<nnue::AccStack>();
+  nnue::attach(pos, ctx.acc.get());
+}
+
+// m followed by the child's line becomes the line at ply.
+static inline void update_pv(SearchContext& ctx, int ply, Move m) {
+  Move* dst = ctx.pv[ply];
+  const Move* src = ctx.pv[ply + 1];
+  dst[ply] = m;
+  const int end = std::max(ctx.pvLen[ply + 1], ply + 1);
+  for (int i = ply + 1; i < end; i++) dst[i] = src[i];
+  ctx.pvLen[ply] = end;
+}
+
+// Root move m plus the line below it (after a root-level search of m at ply 1).
+static std::vector<Move> root_line(const SearchContext& ctx, Move m) {
+  std::vector<Move> line{m};
+  line.insert(line.end(), ctx.pv[1] + 1, ctx.pv[1] + std::max(ctx.pvLen[1], 1));
+  return line;
+}
+
+// ------------------------------------------------------------
+// ABDADA "currently searching" table
+// ------------------------------------------------------------
+// One slot per (position, move) hash. A thread marks a move before searching it at a
+// non-PV node and clears it afterwards; other threads seeing the mark push the move to
+// the end of their list. Collisions only change move order, never results.
+static constexpr int ABDADA_DEFER_DEPTH = 3;
+static constexpr size_t ABDADA_SIZE = 1u << 15;
+static std::atomic<uint64_t> abdadaTable[ABDADA_SIZE];
+
+static inline uint64_t abdada_key(uint64_t posKey, Move m) {
+  return posKey ^ ((uint64_t)m * 0x9e3779b97f4a7c15ULL);
+}
+
+static inline bool abdada_busy(uint64_t k) {
+  return abdadaTable[k & (ABDADA_SIZE - 1)].load(std::memory_order_relaxed) == k;
+}
+
+static inline void abdada_start(uint64_t k) {
+  abdadaTable[k & (ABDADA_SIZE - 1)].store(k, std::memory_order_relaxed);
+}
+
+static inline void abdada_finish(uint64_t k) {
+  uint64_t expected = k;
+  abdadaTable[k & (ABDADA_SIZE - 1)].compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+}
+
+// Hot-path stop check: the timer thread / UCI "stop" set the flag, searchers only need
+// to notice eventually, so a relaxed load is enough (no fence, no clock read per node).
+static inline bool stopped(const Searcher& S) {
+  return S.stopFlag.load(std::memory_order_relaxed);
+}
+
+// Owner-only counter increment: plain load/store, no locked RMW on the hot path.
+static inline void bump(std::atomic<uint64_t>& c) {
+  c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 }
 
 static inline bool repetition_draw(const Position& pos, const SearchContext& ctx, int ply) {
@@ -410,34 +484,82 @@ static inline bool repetition_draw(const Position& pos, const SearchContext& ctx
   return false;
 }
 
+// Count a node for this thread and enforce "go nodes": exact with one thread, otherwise
+// every 1024 own nodes the slots of all threads are summed.
+static inline void count_node(SearchContext& ctx) {
+  bump(ctx.stats->nodes);
+  const Searcher& S = *ctx.S;
+  if (S.nodeLimit == 0) return;
+  const uint64_t n = ctx.stats->nodes.load(std::memory_order_relaxed);
+  if (S.threads == 1 ? n >= S.nodeLimit : ((n & 1023) == 0 && S.totals().nodes >= S.nodeLimit))
+    ctx.S->stopFlag.store(true, std::memory_order_relaxed);
+}
+
 static int qsearch(Position& pos, int alpha, int beta, int ply, SearchContext& ctx, Move prevMove, int qCheckDepth) {
   Searcher& S = *ctx.S;
   Searcher::Heuristics& H = *ctx.H;
 
-  if (S.stopFlag.load() || time_up(ctx)) { S.stop(); return 0; }
+  if (stopped(S)) return 0;
   if (ply >= Searcher::MAX_PLY - 1) return eval(pos);
 
   // Mate distance pruning (tighten bounds)
   alpha = std::max(alpha, -MATE + ply);
   beta  = std::min(beta,  MATE - ply - 1);
   if (alpha >= beta) return alpha;
-  ctx.nodes++;
+  count_node(ctx);
+  bump(ctx.stats->qnodes);
   if (ply > ctx.selDepth) ctx.selDepth = ply;
 
   if (repetition_draw(pos, ctx, ply)) return 0;
 
   // If side to move is in check in quiescence, we must search evasions.
-  bool inCheck = pos.is_attacked(pos.kingSq[pos.stm], !pos.stm);
+  bool inCheck = pos.checkers() != 0;
+
+  // TT probe: any entry at least as deep as this q level may cut; otherwise its move
+  // still goes first.
+  const int qDepth = (qCheckDepth > 0) ? TT_DEPTH_QS_CHECKS : TT_DEPTH_QS;
+  TTEntry tte;
+  Move ttMove = 0;
+  int ttScore = 0;
+  const bool ttHit = S.tt.probe(pos.key, tte);
+  if (ttHit) {
+    bump(ctx.stats->ttHits);
+    ttMove = pos.move_from_compact(tte.move);
+    ttScore = S.tt.unpack_score((int)tte.score, ply);
+    if (tte.depth >= qDepth) {
+      if (tte.flag == TT_EXACT) return ttScore;
+      if (tte.flag == TT_ALPHA && ttScore <= alpha) return alpha;
+      if (tte.flag == TT_BETA  && ttScore >= beta)  return beta;
+    }
+  }
 
+  // Don't let a quiescence result replace a deeper entry for the same position.
+  const bool store = !ttHit || tte.depth <= qDepth;
+  const int origAlpha = alpha;
   int stand = 0;
   if (!inCheck) {
-    stand = eval(pos);
-    if (stand >= beta) return beta;
+    stand = (ttHit && tte.eval != TT_EVAL_NONE) ? (int)tte.eval : eval(pos);
+    if (stand >= beta) {
+      // Stand-pat is the usual qsearch exit: keep the static eval it just paid for.
+      if (store) S.tt.store(pos.key, qDepth, S.tt.pack_score(beta, ply), TT_BETA, 0, stand);
+      return beta;
+    }
     if (stand > alpha) alpha = stand;
   }
 
+  // Only generate what quiescence can use: every evasion when in check, otherwise
+  // captures/promotions plus (first q ply only) quiet checking moves.
   MoveList ml;
-  pos.gen_pseudo(ml);
+  if (inCheck) {
+    pos.gen_evasions(ml);
+  } else {
+    pos.gen_captures(ml);
+    if (qCheckDepth > 0) {
+      MoveList qc;
+      pos.gen_quiet_checks(qc);
+      for (int i = 0; i < qc.size; i++) ml.push(qc.moves[i]);
+    }
+  }
 
   // Score captures/promotions, plus (very selectively) quiet checks at the first q ply.
   // Hot path: avoid heap allocations and full sorting.
@@ -449,9 +571,6 @@ static int qsearch(Position& pos, int alpha, int beta, int ply, SearchContext& c
   for (int i = 0; i < ml.size; i++) {
     Move m = ml.moves[i];
     const bool capOrPromo = is_capture(m) || is_promo(m);
-    // If side is in check in quiescence, we must consider *all* evasions.
-    // Otherwise consider captures/promotions, plus (very selectively) quiet checks.
-    if (!capOrPromo && !inCheck && qCheckDepth <= 0) continue;
 
     if (capOrPromo) {
       // delta pruning: if even a winning capture can't raise alpha, skip
@@ -461,27 +580,13 @@ static int qsearch(Position& pos, int alpha, int beta, int ply, SearchContext& c
       // SEE pruning for losing captures
       if (!see_ge(pos, m, -50)) continue;
 
-      int sc = move_score_basic(H, pos, m, 0, prevMove, ply);
+      int sc = move_score_basic(H, pos, m, ttMove, prevMove, ply);
       if (count < Q_MAX_MOVES) { moves[count] = m; scores[count] = sc; count++; }
       continue;
     }
 
-    // Quiet check candidates (first q ply only): try move, keep only if it gives check.
-    // When inCheck, this branch is used for quiet evasions too.
-    Undo u;
-    Color us0 = pos.stm;
-    pos.make(m, u);
-    bool legal = !pos.is_attacked(pos.kingSq[us0], !us0);
-    bool givesCheck = false;
-    if (legal) {
-      Color them = !us0;
-      givesCheck = pos.is_attacked(pos.kingSq[them], us0);
-    }
-    pos.unmake(m, u);
-    if (!legal) continue;
-    if (!inCheck && !givesCheck) continue;
-
-    int sc = (inCheck ? 2'000'000 : 1'000'000) + H.history[pos.stm][m_from(m)][m_to(m)];
+    // Quiet checks (first q ply only), or quiet evasions when in check.
+    int sc = (m == ttMove ? 10'000'000 : inCheck ? 2'000'000 : 1'000'000) + H.history[pos.stm][m_from(m)][m_to(m)];
     // Prefer checks that look like good follow-ups (continuation history)
     if (prevMove) {
       int pp = m_piece(prevMove);
@@ -522,25 +627,29 @@ static int qsearch(Position& pos, int alpha, int beta, int ply, SearchContext& c
     count = fcount;
   }
 
-Color us = pos.stm;
+  const int ttEval = inCheck ? TT_EVAL_NONE : stand;
+  Move bestMove = 0;
+
   for (int mi = 0; mi < count; mi++) {
     Move m = moves[mi];
     Undo u;
     pos.make(m,u);
-    bool legal = !pos.is_attacked(pos.kingSq[us], !us);
-    if (!legal) { pos.unmake(m,u); continue; }
 
     ctx.keyStack[ply+1] = pos.key;
     // We only allow quiet checks at the first q ply. Deeper qsearch is captures/promotions only.
     int score = -qsearch(pos, -beta, -alpha, ply+1, ctx, m, 0);
     pos.unmake(m,u);
 
-    if (S.stopFlag.load()) return 0;
+    if (stopped(S)) return 0;
 
-    if (score >= beta) return beta;
-    if (score > alpha) alpha = score;
+    if (score >= beta) {
+      if (store) S.tt.store(pos.key, qDepth, S.tt.pack_score(beta, ply), TT_BETA, (uint32_t)m, ttEval);
+      return beta;
+    }
+    if (score > alpha) { alpha = score; bestMove = m; }
   }
 
+  if (store) S.tt.store(pos.key, qDepth, S.tt.pack_score(alpha, ply), alpha > origAlpha ? TT_EXACT : TT_ALPHA, bestMove, ttEval);
   return alpha;
 }
 
@@ -549,7 +658,8 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
   Searcher& S = *ctx.S;
   Searcher::Heuristics& H = *ctx.H;
 
-  if (S.stopFlag.load() || time_up(ctx)) { S.stop(); return 0; }
+  ctx.pvLen[ply] = ply;
+  if (stopped(S)) return 0;
   if (ply >= Searcher::MAX_PLY - 1) return eval(pos);
 
   // Mate distance pruning (tighten bounds)
@@ -557,10 +667,17 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
   beta  = std::min(beta,  MATE - ply - 1);
   if (alpha >= beta) return alpha;
 
-  ctx.nodes++;
+  // Keep a PV line wherever the window is open (PV nodes, including PVS re-searches).
+  const bool trackPv = pvNode || beta - alpha > 1;
+
+  // MultiPV line 2+ searches the root without some moves: the root TT entry describes
+  // the full move list, so it must neither bound nor be overwritten by this search.
+  const bool rootExclusion = ply == 0 && !ctx.rootExcluded.empty();
+
+  count_node(ctx);
   if (ply > ctx.selDepth) ctx.selDepth = ply;
 
-  bool inCheck = pos.is_attacked(pos.kingSq[pos.stm], !pos.stm);
+  bool inCheck = pos.checkers() != 0;
 
   // Check extension
   if (inCheck) depth++;
@@ -574,6 +691,7 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
     if (pieces <= syzygy::largest()) {
       int wdl;
       if (syzygy::probe_wdl(pos, wdl)) {
+        bump(ctx.stats->tbhits);
         return wdl_to_score(wdl, ply);
       }
     }
@@ -588,7 +706,8 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
   Move ttMove = 0;
   if (S.tt.probe(pos.key, tte)) {
     ttHit = true;
-    ttMove = (Move)tte.bestMove;
+    bump(ctx.stats->ttHits);
+    ttMove = pos.move_from_compact(tte.move);
     ttScore = S.tt.unpack_score((int)tte.score, ply);
     if (tte.depth >= depth && !pvNode) {
       if (tte.flag == TT_EXACT) return ttScore;
@@ -597,15 +716,11 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
     }
   }
 
-  // PV bound tightening: even when we can't return immediately, we can use
-  // the stored bound to narrow the window and speed up the PV search.
-  if (ttHit && tte.depth >= depth && pvNode && tte.flag != TT_EXACT) {
-    if (tte.flag == TT_ALPHA) {
-      beta = std::min(beta, ttScore);
-    } else if (tte.flag == TT_BETA) {
-      alpha = std::max(alpha, ttScore);
-    }
-    if (alpha >= beta) return alpha;
+  // PV nodes still take a stored bound that falls outside the window. Narrowing the
+  // window to it instead would end the line whenever the search lands on the bound.
+  if (ttHit && tte.depth >= depth && pvNode && tte.flag != TT_EXACT && !rootExclusion) {
+    if (tte.flag == TT_ALPHA && ttScore <= alpha) return alpha;
+    if (tte.flag == TT_BETA  && ttScore >= beta)  return beta;
   }
 
   // Internal Iterative Deepening (IID): if we have no TT move at a PV node,
@@ -614,25 +729,26 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
     int iidDepth = depth - 2;
     if (iidDepth > 0) {
       (void)negamax(pos, alpha, beta, iidDepth, ply, true, prevMove, ctx, 0, false);
-      if (S.stopFlag.load()) return 0;
+      if (stopped(S)) return 0;
       TTEntry t2;
-      if (S.tt.probe(pos.key, t2)) ttMove = (Move)t2.bestMove;
+      if (S.tt.probe(pos.key, t2)) ttMove = pos.move_from_compact(t2.move);
     }
   }
 
   int origAlpha = alpha;
 
   // Static eval for pruning (only when not in check).
-  // This is a hot path, so avoid calling eval() if we won't use it.
+  // This is a hot path, so avoid calling eval() if we won't use it; a TT hit carries it.
   int staticEval = 0;
   bool improving = false;
   if (!inCheck) {
-    staticEval = eval(pos);
+    staticEval = (ttHit && tte.eval != TT_EVAL_NONE) ? (int)tte.eval : eval(pos);
     ctx.stack[ply].staticEval = staticEval;
     improving = (ply >= 2 && staticEval > ctx.stack[ply-2].staticEval);
   } else {
     ctx.stack[ply].staticEval = 0;
   }
+  const int ttEval = inCheck ? TT_EVAL_NONE : staticEval;
 
   // Reverse futility
   if (!pvNode && !inCheck && depth <= 3) {
@@ -656,13 +772,13 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
     ctx.keyStack[ply+1] = pos.key;
     int score = -negamax(pos, -beta, -beta+1, depth - 1 - R, ply+1, false, 0, ctx, 0, false);
     pos.unmake_null(u);
-    if (S.stopFlag.load()) return 0;
+    if (stopped(S)) return 0;
 
     if (score >= beta) {
       if (depth >= 8) {
         // Verification search from the original position at reduced depth
         int vscore = negamax(pos, beta-1, beta, depth - 1 - R, ply, false, prevMove, ctx, 0, false);
-        if (S.stopFlag.load()) return 0;
+        if (stopped(S)) return 0;
         if (vscore >= beta) return beta;
       } else {
         return beta;
@@ -678,7 +794,7 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
     int singDepth = depth - 4;
     if (singDepth > 0) {
       int others = negamax(pos, singBeta - 1, singBeta, singDepth, ply, false, prevMove, ctx, ttMove, false);
-      if (S.stopFlag.load()) return 0;
+      if (stopped(S)) return 0;
       if (others < singBeta) singularExtend = true;
     }
   }
@@ -690,7 +806,7 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
     int pcDepth = depth - 4;
     if (pcDepth > 0) {
       MoveList pc;
-      pos.gen_pseudo(pc);
+      pos.gen_legal(pc);
       std::vector<std::pair<int,Move>> caps;
       caps.reserve(pc.size);
       for (int i = 0; i < pc.size; i++) {
@@ -701,48 +817,23 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
       }
       sort_moves(caps);
       int tried = 0;
-      Color us = pos.stm;
       for (auto& sm : caps) {
         if (tried++ >= 6) break;
         Move m = sm.second;
         Undo u;
         pos.make(m, u);
-        bool legal = !pos.is_attacked(pos.kingSq[us], !us);
-        if (!legal) { pos.unmake(m, u); continue; }
         ctx.keyStack[ply+1] = pos.key;
         int score = -negamax(pos, -pcBeta, -(pcBeta - 1), pcDepth, ply+1, false, m, ctx, 0, false);
         pos.unmake(m, u);
-        if (S.stopFlag.load()) return 0;
+        if (stopped(S)) return 0;
         if (score >= pcBeta) return beta;
       }
     }
   }
 
-  // Generate and order moves
-  MoveList ml;
-  pos.gen_pseudo(ml);
-
-  // Hot path: avoid allocations and full sorting in every node.
-  static constexpr int N_MAX_MOVES = 256;
-  Move moves[N_MAX_MOVES];
-  int  scores[N_MAX_MOVES];
-  int  count = 0;
-
-  for (int i = 0; i < ml.size; i++) {
-    Move m = ml.moves[i];
-    if (count < N_MAX_MOVES) {
-      moves[count] = m;
-      scores[count] = move_score_basic(H, pos, m, ttMove, prevMove, ply);
-      count++;
-    }
-  }
-
-  // Order moves by score (descending) using selection to avoid heap traffic.
-  for (int i = 0; i < count; i++) {
-    int best = i;
-    for (int j = i + 1; j < count; j++) if (scores[j] > scores[best]) best = j;
-    if (best != i) { std::swap(scores[i], scores[best]); std::swap(moves[i], moves[best]); }
-  }
+  // Staged move ordering: later stages are only generated if earlier ones don't cut off.
+  MovePicker picker(pos, H, ttMove, prevMove, ply, inCheck);
+  const CheckInfo ci(pos);
 
   Color us = pos.stm;
   Move bestMove = 0;
@@ -757,18 +848,35 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
     return 999;
   };
 
-  for (int idx = 0; idx < count; idx++) {
-    Move m = moves[idx];
+  ctx.pvLen[ply] = ply; // IID / verification searches above may have left a line here
+
+  // ABDADA: moves deferred because another thread is on them; searched after the rest.
+  Move deferred[256];
+  int nDeferred = 0, deferIdx = 0;
+
+  int idx = -1;
+  for (;;) {
+    Move m = picker.next();
+    const bool deferredPass = (m == 0);
+    if (deferredPass) {
+      if (deferIdx >= nDeferred) break;
+      m = deferred[deferIdx++];
+    }
+    // A deferred move already passed the pruning checks below on its first visit;
+    // re-checking it with a larger legalMoves/idx would prune it only because it was busy.
+    if (!deferredPass) idx++;
     if (excludedMove && m == excludedMove) continue;
+    if (ply == 0 && (!is_search_move(S, m) ||
+                     std::find(ctx.rootExcluded.begin(), ctx.rootExcluded.end(), m) != ctx.rootExcluded.end())) continue;
 
     // LMP for quiet moves
-    if (!pvNode && !inCheck && depth <= 3 && legalMoves >= lmp_limit(depth) && !is_capture(m) && !is_promo(m)) {
+    if (!deferredPass && !pvNode && !inCheck && depth <= 3 && legalMoves >= lmp_limit(depth) && !is_capture(m) && !is_promo(m)) {
       continue;
     }
 
     // Main-node SEE pruning for obviously losing captures (helps avoid tactical noise).
     // Keep TT move and promotions; don't apply in PV or in check.
-    if (!pvNode && !inCheck && is_capture(m) && !is_promo(m) && m != ttMove) {
+    if (!deferredPass && !pvNode && !inCheck && is_capture(m) && !is_promo(m) && m != ttMove) {
       // More aggressive at shallow depth.
       int thr = (depth <= 3 ? -50 : -100);
       if (!see_ge(pos, m, thr)) {
@@ -776,31 +884,21 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
       }
     }
 
+    const bool givesCheck = pos.gives_check(m, ci);
+
     // Futility pruning (quiet moves only)
-    if (!pvNode && !inCheck && depth <= 3 && !is_capture(m) && !is_promo(m)) {
+    if (!deferredPass && !pvNode && !inCheck && depth <= 3 && !is_capture(m) && !is_promo(m)) {
       static const int fm[4] = {0, 90, 170, 260};
-      if (staticEval + fm[depth] <= alpha) {
-        // Keep checks (very crude: if move gives check, don't prune)
-        Undo tu;
-        pos.make(m, tu);
-        bool givesCheck = pos.is_attacked(pos.kingSq[!us], us);
-        pos.unmake(m, tu);
-        if (!givesCheck) continue;
-      }
+      // Keep checks (very crude: if move gives check, don't prune)
+      if (staticEval + fm[depth] <= alpha && !givesCheck) continue;
     }
 
-    Undo u;
-    pos.make(m,u);
-    bool legal = !pos.is_attacked(pos.kingSq[us], !us);
-    if (!legal) { pos.unmake(m,u); continue; }
-
-	    // Safe history pruning (quiet moves only). IMPORTANT: apply only after legality is known,
-	    // and never prune checking moves. This avoids "depth but blind" behavior.
-	    if (!pvNode && !inCheck && depth >= g_params.hist_prune_min_depth && !is_capture(m) && !is_promo(m) && m != ttMove) {
+	    // Safe history pruning (quiet moves only). Never prune checking moves.
+	    // This avoids "depth but blind" behavior.
+	    if (!deferredPass && !pvNode && !inCheck && depth >= g_params.hist_prune_min_depth && !is_capture(m) && !is_promo(m) && m != ttMove) {
 	      // Only prune very late moves (depth-scaled)
 	      const int late = g_params.hist_prune_late_base + depth * g_params.hist_prune_late_per_depth;
 	      if (idx >= late) {
-	        const bool givesCheck = pos.is_attacked(pos.kingSq[!us], us);
 	        if (!givesCheck && m != H.killers[ply][0] && m != H.killers[ply][1]) {
 	          bool isCM = false;
 	          int cont = 0;
@@ -816,14 +914,27 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
 	          if (!isCM) {
 	            int h = H.history[us][m_from(m)][m_to(m)] + cont;
 	            // Require *very* negative history to prune.
-	            if (h < g_params.hist_prune_threshold) { pos.unmake(m,u); continue; }
+	            if (h < g_params.hist_prune_threshold) continue;
 	          }
 	        }
 	      }
 	    }
 
+    uint64_t abdadaKey = 0;
+    if (ctx.abdada && !pvNode && depth >= ABDADA_DEFER_DEPTH && legalMoves > 0) {
+      abdadaKey = abdada_key(pos.key, m);
+      if (!deferredPass && abdada_busy(abdadaKey)) { deferred[nDeferred++] = m; continue; }
+      abdada_start(abdadaKey);
+    }
+
+    Undo u;
+    pos.make(m,u);
+
     legalMoves++;
     ctx.keyStack[ply+1] = pos.key;
+    // Root effort counts only the real root loop, not ply-0 IID/singular/verification searches.
+    const bool rootEffort = ply == 0 && ctx.tm && !excludedMove && allowIID;
+    const uint64_t nodesBefore = rootEffort ? ctx.stats->nodes.load(std::memory_order_relaxed) : 0;
 
     bool childPv = pvNode && (legalMoves == 1);
     int newDepth = depth - 1 + ((singularExtend && m == ttMove) ? 1 : 0);
@@ -845,7 +956,6 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
         if (improving) r = std::max(0, r - 1);
 
         // Reduce less for checking moves (tactical)
-        const bool givesCheck = pos.is_attacked(pos.kingSq[!us], us);
         if (givesCheck) r = std::max(0, r - g_params.lmr_check_bonus);
 
         // Use history/continuation to adjust reductions.
@@ -872,15 +982,18 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
 
       // Reduced null-window search
       score = -negamax(pos, -alpha-1, -alpha, rd, ply+1, false, m, ctx, 0, false);
-      if (score > alpha && !S.stopFlag.load()) {
-        // Re-search at full depth
-        score = -negamax(pos, -beta, -alpha, newDepth, ply+1, childPv, m, ctx, 0, false);
+      if (score > alpha && !stopped(S)) {
+        // Re-search at full depth; in a PV node this child may become the PV, so it is
+        // searched as a PV node (no TT cutoffs or pruning that would leave its line empty).
+        score = -negamax(pos, -beta, -alpha, newDepth, ply+1, pvNode, m, ctx, 0, false);
       }
     }
 
     pos.unmake(m,u);
+    if (abdadaKey) abdada_finish(abdadaKey);
+    if (rootEffort) ctx.tm->add_root_nodes(m, ctx.stats->nodes.load(std::memory_order_relaxed) - nodesBefore);
 
-    if (S.stopFlag.load()) return 0;
+    if (stopped(S)) return 0;
 
     if (score > bestScore) {
       bestScore = score;
@@ -889,7 +1002,7 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
 
     if (score > alpha) {
       alpha = score;
-      // update pv-ish
+      if (trackPv) update_pv(ctx, ply, m);
     }
 
     if (alpha >= beta) {
@@ -921,7 +1034,7 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
       }
 
       // store TT beta
-      S.tt.store(pos.key, depth, S.tt.pack_score(beta, ply), TT_BETA, (uint32_t)m);
+      if (!rootExclusion) S.tt.store(pos.key, depth, S.tt.pack_score(beta, ply), TT_BETA, (uint32_t)m, ttEval);
       return beta;
     }
   }
@@ -934,7 +1047,7 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
 
   // store TT
   uint8_t flag = (alpha <= origAlpha) ? TT_ALPHA : TT_EXACT;
-  S.tt.store(pos.key, depth, S.tt.pack_score(alpha, ply), flag, (uint32_t)bestMove);
+  if (!rootExclusion) S.tt.store(pos.key, depth, S.tt.pack_score(alpha, ply), flag, bestMove, ttEval);
 
   // Expose best move for the current ply (useful at root even if TT collides)
   ctx.stack[ply].pvMove = bestMove;
@@ -942,57 +1055,28 @@ static int negamax(Position& pos, int alpha, int beta, int depth, int ply, bool
   return alpha;
 }
 
-static inline int compute_time_limit_ms(const Position& pos, const GoLimits& lim) {
-  if (lim.movetime_ms > 0) return lim.movetime_ms;
-  if (lim.depth > 0) return 0;
-
-  int time = (pos.stm == WHITE) ? lim.wtime_ms : lim.btime_ms;
-  int inc  = (pos.stm == WHITE) ? lim.winc_ms  : lim.binc_ms;
-
-  if (time <= 0) return 0;
-
-  // Moves to go: UCI might not provide it. Use a conservative default.
-  int mtg = (lim.movestogo > 0) ? lim.movestogo : 30;
-  mtg = std::max(5, std::min(70, mtg));
-
-  // If we're in real time trouble, keep it very small.
-  if (time < 1500) {
-    int limMs = std::max(5, time / 12 + inc / 2);
-    return std::min(limMs, std::max(5, time / 3));
-  }
-
-  // Base budget: a slice of remaining time + most of the increment.
-  // Using (mtg + 6) gives more stable allocations than time/mtg.
-  double base = (double)time / (double)(mtg + 6);
-  base += 0.75 * (double)inc;
-
-  // Phase scaling: spend a bit more in the opening, a bit less in late endgames.
-  int fm = (int)pos.fullmoveNumber;
-  if (fm <= 12) base *= 1.15;
-  else if (fm >= 40) base *= 0.95;
-
-  // Endgame scaling: if very few pieces remain, avoid over-investing.
-  int pieces = popcount64(pos.occAll);
-  if (pieces <= 10) base *= 0.85;
-
-  int limit = (int)base;
-  // Never use too much of remaining time (hard safety)
-  limit = std::min(limit, time / 2);
-  // Never use too little
-  limit = std::max(limit, 5);
-  return limit;
-}
-
 Move Searcher::go(Position& pos, const GoLimits& lim) {
   stopFlag.store(false);
+  ponderMove = 0;
+  nodeLimit = lim.nodes;
+  searchMoves.clear();
+  if (!lim.searchmoves.empty()) {
+    MoveList legal;
+    pos.gen_legal(legal);
+    for (Move m : lim.searchmoves)
+      if (std::find(legal.moves, legal.moves + legal.size, m) != legal.moves + legal.size) searchMoves.push_back(m);
+  }
+  tt.allocate();
   tt.new_search();
 
   if (useSyzygy && !syzygyPath.empty()) {
     syzygy::init(syzygyPath);
   }
 
-  // Syzygy root probe (fast)
-  if (useSyzygy && syzygy::enabled()) {
+  // Syzygy root probe (fast). Not while pondering or in infinite mode (bestmove must
+  // wait), nor with searchmoves (the TB move may not be among them).
+  const bool rootShortcuts = !pondering.load() && !lim.infinite && searchMoves.empty();
+  if (rootShortcuts && useSyzygy && syzygy::enabled()) {
     Move tbMove;
     int wdl;
     int dtz = 0;
@@ -1015,7 +1099,7 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
     return ply;
   };
 
-  if (useBook && book.loaded()) {
+  if (rootShortcuts && useBook && book.loaded()) {
     int ply = game_ply(pos);
     if (ply <= bookMaxPly) {
       Move bm = probe_book(pos);
@@ -1035,30 +1119,28 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
   ctx.H = &heurByThread[0];
   ctx.allowSyzygy = true;
   ctx.start = std::chrono::steady_clock::now();
-  // Compute hard/soft time limits.
-  // For movetime: use (movetime - overhead) as hard, and stop at soft if PV is stable.
-  // For clock mode: compute a budget and keep a small safety margin.
-  int baseLimit = compute_time_limit_ms(pos, lim);
-  if (baseLimit > 0) {
-    int hard = baseLimit - moveOverheadMs;
-    hard = std::max(1, hard);
-    // Soft limit: aim to stop a bit early to avoid overrun and to stop at clean iteration boundaries.
-    // Keep this modest so we still use nearly all allotted time for difficult positions.
-    int softSlack = std::min(1000, std::max(50, hard / 20)); // ~5% (capped at 1s)
-    int soft = std::max(1, hard - softSlack);
-    ctx.hardLimitMs = hard;
-    ctx.softLimitMs = soft;
-  } else {
-    ctx.hardLimitMs = 0;
-    ctx.softLimitMs = 0;
+  ctx.tm = &tm;
+  // Optimum/maximum time for this move; the hard limit is enforced by the timer thread.
+  tm.init(pos, lim, moveOverheadMs, ctx.start);
+  MoveList rootMoves;
+  if (searchMoves.empty()) pos.gen_legal(rootMoves);
+  else for (Move m : searchMoves) rootMoves.push(m);
+  tm.set_root_moves(rootMoves);
+  timer_root_ready(false);
+  {
+    std::lock_guard<std::mutex> lk(ponderMutex);
+    searchActive = true;
+    if (!pondering.load() && tm.hard_ms() > 0) start_timer(ctx.start + std::chrono::milliseconds(tm.hard_ms()));
   }
-  ctx.nodes = 0;
   ctx.rootHistoryLen = (int)pos.gameKeys.size();
   if (ctx.rootHistoryLen > (int)pos.gameKeys.size()) ctx.rootHistoryLen = (int)pos.gameKeys.size();
   ctx.keyStack[0] = pos.key;
+  attach_nnue(ctx, pos);
 
   Move best = 0;
   int bestScore = -INF;
+  std::vector<Move> bestPv;
+  std::vector<int> multiPvScores; // per-line scores of the last MultiPV iteration
 
   int maxD = (lim.depth > 0) ? lim.depth : 64;
   if (maxDepth > 0) maxD = std::min(maxD, maxDepth);
@@ -1071,36 +1153,61 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
     set_threads(nThreads);
     ctx.H = &heurByThread[0];
   }
-
+  clear_stats();
+  ctx.stats = &stats[0];
+
+  // Helpers either run their own searches (Lazy SMP / ABDADA, and always with MultiPV,
+  // where the root loop is serial) or take part in the per-depth parallel root split
+  // below; never both, so the engine uses exactly `threads` threads. Idle helpers sleep.
+  const bool abdadaMode = nThreads > 1 && smpMode == SMP_ABDADA;
+  const bool lazyHelpers = nThreads > 1 && (abdadaMode || smpMode == SMP_LAZY || multiPV > 1);
+  const bool rootSplit = nThreads > 1 && !lazyHelpers;
+  ctx.abdada = abdadaMode;
   std::atomic<int> sharedDepth{0};
-  std::vector<std::thread> workers;
-  workers.reserve(std::max(0, nThreads - 1));
+  std::mutex depthMutex;
+  std::condition_variable depthCv;
 
-  if (nThreads > 1) {
-    // Helper threads search slightly behind the main thread to populate the TT.
+  if (lazyHelpers) {
+    // Helper threads search slightly behind the main thread to populate the TT
+    // (Lazy SMP), or run their own iterative deepening with move deferral (ABDADA).
     for (int t = 1; t < nThreads; t++) {
       Position rootCopy = pos; // independent copy
-      workers.emplace_back([this, t, root = std::move(rootCopy), &sharedDepth,
-                            start = ctx.start, hard = ctx.hardLimitMs, soft = ctx.softLimitMs,
-                            maxD]() mutable {
+      helpers.run(t - 1, [this, t, root = std::move(rootCopy), &sharedDepth, &depthMutex, &depthCv,
+                          start = ctx.start, maxD, abdadaMode]() mutable {
         SearchContext hctx;
         hctx.S = this;
         hctx.H = &heurByThread[t];
         hctx.allowSyzygy = false; // avoid concurrent TB probing
         hctx.start = start;
-        hctx.hardLimitMs = hard;
-        hctx.softLimitMs = soft;
-        hctx.nodes = 0;
+        hctx.stats = &stats[t];
         hctx.selDepth = 0;
         hctx.rootHistoryLen = (int)root.gameKeys.size();
         hctx.keyStack[0] = root.key;
+        attach_nnue(hctx, root);
+
+        if (abdadaMode) {
+          // Independent iterative deepening; the deferral table spreads threads apart.
+          hctx.abdada = true;
+          for (int d = 1; d <= maxD && !stopFlag.load(std::memory_order_relaxed); d++) {
+            hctx.selDepth = 0;
+            (void)negamax(root, -INF, INF, d, 0, true, 0, hctx);
+          }
+          return;
+        }
 
         int last = 0;
-        while (!stopFlag.load(std::memory_order_relaxed)) {
-          int d = sharedDepth.load(std::memory_order_relaxed);
-          if (d <= 1) { std::this_thread::yield(); continue; }
-          int sd = std::max(1, std::min(maxD, d - 1));
-          if (sd == last) { std::this_thread::yield(); continue; }
+        for (;;) {
+          int sd = 0;
+          {
+            std::unique_lock<std::mutex> lk(depthMutex);
+            depthCv.wait(lk, [&] {
+              if (stopFlag.load(std::memory_order_relaxed)) return true;
+              int d = sharedDepth.load(std::memory_order_relaxed);
+              sd = std::max(1, std::min(maxD, d - 1));
+              return d > 1 && sd != last;
+            });
+          }
+          if (stopFlag.load(std::memory_order_relaxed)) break;
           last = sd;
 
           hctx.selDepth = 0;
@@ -1111,34 +1218,24 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
     }
   }
 
-  Move prevIterBest = 0;
-  int prevIterScore = 0;
-  int stableCount = 0;
-
-  // Root ordering persistence across iterations (helps fixed-time strength).
-  std::unordered_map<uint32_t, int> rootScoreHint;
-
   for (int depth=1; depth<=maxD; depth++) {
     if (stopFlag.load()) break;
 
     // Let helper threads know what depth we're starting.
-    sharedDepth.store(depth, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lk(depthMutex);
+      sharedDepth.store(depth, std::memory_order_relaxed);
+    }
+    depthCv.notify_all();
 
     // Reset selDepth per iteration (UCI convention).
     ctx.selDepth = 0;
 
-    // If we're already past the soft limit and the PV has been stable, don't start a new depth.
-    if (ctx.softLimitMs > 0) {
-      auto now = std::chrono::steady_clock::now();
-      auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - ctx.start).count();
-      if (ms >= ctx.softLimitMs && stableCount >= 2 && prevIterBest != 0)
-        break;
-    }
-
     auto print_info = [&](int multipvIdx, int score, const std::string& pv) {
       auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - ctx.start).count();
       if (ms < 1) ms = 1;
-      const int nps = (int)((ctx.nodes * 1000) / ms);
+      const SearchTotals tot = totals();
+      const uint64_t nps = (tot.nodes * 1000) / (uint64_t)ms;
       const int hf = tt.hashfull();
 
       std::cout << "info depth " << depth
@@ -1158,8 +1255,9 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
         std::cout << "cp " << score;
       }
 
-      std::cout << " nodes " << ctx.nodes
+      std::cout << " nodes " << tot.nodes
                 << " nps " << nps
+                << " tbhits " << tot.tbhits
                 << " hashfull " << hf
                 << " time " << ms;
 
@@ -1167,101 +1265,97 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
       std::cout << std::endl;
     };
 
-    // MultiPV analysis: score each root move independently (slower, but accurate and simple).
-    if (multiPV > 1) {
-      struct RootLine { Move m; int score; };
-      std::vector<std::pair<int,Move>> rootMoves;
-      rootMoves.reserve(64);
-
-      // Seed ordering with TT move (if any)
-      TTEntry rt;
-      Move ttMove = 0;
-      if (tt.probe(pos.key, rt) && rt.bestMove) ttMove = (Move)rt.bestMove;
-
-      MoveList ml;
-      pos.gen_pseudo(ml);
-      for (int i = 0; i < ml.size; i++) {
-        Move m = ml.moves[i];
-        // Basic legality check (cheaper than full make/unmake for ordering, but we verify later)
-        int sc = move_score_basic(heurByThread[0], pos, m, ttMove, 0, 0);
-        rootMoves.push_back({sc, m});
+    // Aspiration window search of the whole root (depth >= 2), centred on a previous
+    // score. Without a centre (depth 1, or a MultiPV line that did not exist last
+    // iteration) it uses the full window.
+    auto aspiration = [&](bool haveCenter, int center) -> int {
+      if (depth == 1 || !haveCenter) return negamax(pos, -INF, INF, depth, 0, true, 0, ctx);
+
+      int score = 0;
+      int window = g_params.asp_base + depth * g_params.asp_per_depth;
+      int alpha = center - window;
+      int beta  = center + window;
+
+      for (int tries = 0; tries < 5; tries++) {
+        score = negamax(pos, alpha, beta, depth, 0, true, 0, ctx);
+        if (stopFlag.load()) break;
+
+        if (score <= alpha) {
+          window = window * 2 + 10;
+          alpha = center - window;
+          beta  = center + window;
+          continue;
+        }
+        if (score >= beta) {
+          window = window * 2 + 10;
+          alpha = center - window;
+          beta  = center + window;
+          continue;
+        }
+        break;
       }
-      sort_moves(rootMoves);
 
-      std::vector<RootLine> lines;
-      lines.reserve(rootMoves.size());
+      if (!stopFlag.load() && (score <= alpha || score >= beta)) {
+        score = negamax(pos, -INF, INF, depth, 0, true, 0, ctx);
+      }
+      return score;
+    };
 
-      Color us = pos.stm;
-      for (auto& sm : rootMoves) {
-        Move m = sm.second;
-        Undo u;
-        pos.make(m, u);
-        bool legal = !pos.is_attacked(pos.kingSq[us], !us);
-        if (!legal) { pos.unmake(m, u); continue; }
-        ctx.keyStack[1] = pos.key;
+    // Line of the last root search: the PV table, or just the move if it never raised
+    // alpha in the final window (e.g. after a stop).
+    auto root_pv = [&](Move m) -> std::vector<Move> {
+      if (ctx.pvLen[0] > 0 && ctx.pv[0][0] == m) return std::vector<Move>(ctx.pv[0], ctx.pv[0] + ctx.pvLen[0]);
+      return std::vector<Move>{m};
+    };
 
-        int sc = -negamax(pos, -INF, INF, depth - 1, 1, true, m, ctx);
-        pos.unmake(m, u);
+    // MultiPV: line k is a root search that excludes the moves of lines 1..k-1, with an
+    // aspiration window around line k's score from the previous iteration. Helper
+    // threads (Lazy SMP / ABDADA) keep filling the TT meanwhile.
+    if (multiPV > 1) {
+      struct RootLine { Move m; int score; std::vector<Move> pv; };
+      std::vector<RootLine> lines;
+      const int count = std::min(multiPV, rootMoves.size);
+      lines.reserve(count);
+
+      ctx.rootExcluded.clear();
+      for (int k = 0; k < count; k++) {
+        const bool haveCenter = k < (int)multiPvScores.size();
+        const int score = aspiration(haveCenter, haveCenter ? multiPvScores[k] : 0);
         if (stopFlag.load()) break;
-        lines.push_back({m, sc});
+
+        Move m = ctx.stack[0].pvMove;
+        if (!m) break;
+        lines.push_back({m, score, root_pv(m)});
+        ctx.rootExcluded.push_back(m);
       }
+      ctx.rootExcluded.clear();
 
       if (stopFlag.load() || lines.empty()) break;
 
-      std::sort(lines.begin(), lines.end(), [](const RootLine& a, const RootLine& b) {
+      // Aspiration fail-lows can leave later lines above earlier ones.
+      std::stable_sort(lines.begin(), lines.end(), [](const RootLine& a, const RootLine& b) {
         return a.score > b.score;
       });
 
       best = lines[0].m;
       bestScore = lines[0].score;
+      bestPv = lines[0].pv;
 
-      // Print top-N PV lines.
-      const int count = std::min<int>(multiPV, (int)lines.size());
-      for (int i = 0; i < count; i++) {
-        std::string pv = build_pv(pos, *this, lines[i].m, 32);
-        print_info(i + 1, lines[i].score, pv);
+      multiPvScores.clear();
+      for (int i = 0; i < (int)lines.size(); i++) {
+        multiPvScores.push_back(lines[i].score);
+        print_info(i + 1, lines[i].score, pv_to_string(lines[i].pv));
       }
 
     } else {
       int score = 0;
 
       // Root search:
-      // - threads==1: aspiration window PV search
-      // - threads>1: parallel root move scoring (safe, strong for fixed-time)
-
-      if (nThreads <= 1 || depth == 1) {
-        // Aspiration windows (depth >= 2). Use a depth-scaled window.
-        if (depth == 1) {
-          score = negamax(pos, -INF, INF, depth, 0, true, 0, ctx);
-        } else {
-          int center = bestScore;
-          int window = g_params.asp_base + depth * g_params.asp_per_depth;
-          int alpha = center - window;
-          int beta  = center + window;
-
-          for (int tries = 0; tries < 5; tries++) {
-            score = negamax(pos, alpha, beta, depth, 0, true, 0, ctx);
-            if (stopFlag.load()) break;
-
-            if (score <= alpha) {
-              window = window * 2 + 10;
-              alpha = center - window;
-              beta  = center + window;
-              continue;
-            }
-            if (score >= beta) {
-              window = window * 2 + 10;
-              alpha = center - window;
-              beta  = center + window;
-              continue;
-            }
-            break;
-          }
+      // - one root thread (threads==1, Lazy SMP, ABDADA): aspiration window PV search
+      // - SMP_ROOT_SPLIT with threads>1: shared-alpha parallel root move scoring
 
-          if (!stopFlag.load() && (score <= alpha || score >= beta)) {
-            score = negamax(pos, -INF, INF, depth, 0, true, 0, ctx);
-          }
-        }
+      if (!rootSplit || depth == 1) {
+        score = aspiration(true, bestScore);
       } else {
         // Parallel root scoring (similar to MultiPV but parallelized).
         struct RootJob { Move m; int order; };
@@ -1270,44 +1364,49 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
 
         TTEntry rt;
         Move ttMove = 0;
-        if (tt.probe(pos.key, rt) && rt.bestMove) ttMove = (Move)rt.bestMove;
+        if (tt.probe(pos.key, rt)) ttMove = pos.move_from_compact(rt.move);
 
         MoveList ml;
-        pos.gen_pseudo(ml);
+        pos.gen_legal(ml);
 
         for (int i = 0; i < ml.size; i++) {
           Move m = ml.moves[i];
+          if (!is_search_move(*this, m)) continue;
           int sc = move_score_basic(heurByThread[0], pos, m, ttMove, 0, 0);
-          auto it = rootScoreHint.find((uint32_t)m);
-          if (it != rootScoreHint.end()) sc += it->second * 4; // light bias
+          sc += tm.root_order_bonus(m); // moves that took more effort before go first
           jobs.push_back({m, sc});
         }
 
         std::sort(jobs.begin(), jobs.end(), [](const RootJob& a, const RootJob& b){ return a.order > b.order; });
 
-        // Filter legal moves and build move list.
         std::vector<Move> moves;
         moves.reserve(jobs.size());
-        {
-          Color us = pos.stm;
-          for (auto& j : jobs) {
-            Undo u;
-            pos.make(j.m, u);
-            bool legal = !pos.is_attacked(pos.kingSq[us], !us);
-            pos.unmake(j.m, u);
-            if (legal) moves.push_back(j.m);
-          }
-        }
+        for (auto& j : jobs) moves.push_back(j.m);
 
         if (moves.empty()) {
           score = negamax(pos, -INF, INF, depth, 0, true, 0, ctx);
         } else {
-          std::atomic<int> next{0};
-          std::atomic<int> bestSc{-INF};
-          std::atomic<uint32_t> bestMv{0};
-          std::atomic<uint64_t> totalNodes{0};
-          std::vector<std::thread> rootWorkers;
-          rootWorkers.reserve(nThreads - 1);
+          // Shared-alpha root split: the first (expected best) move gets a full window on
+          // its own, then all threads pull the remaining moves and search them with a null
+          // window around the best score so far, re-searching only on fail-high. Score and
+          // move are published together in one atomic so they can never mismatch.
+          auto pack_best = [](int sc, Move m) -> uint64_t {
+            return ((uint64_t)(uint32_t)(sc + INF + 1) << 32) | (uint32_t)m;
+          };
+          auto best_score_of = [](uint64_t v) { return (int)(v >> 32) - INF - 1; };
+
+          std::atomic<int> next{1};
+          std::atomic<uint64_t> bestPacked{pack_best(-INF, 0)};
+          // PV of every move that was searched with an open window; slot i is only
+          // written by the thread that took move i.
+          std::vector<std::vector<Move>> movePv(moves.size());
+          // Each worker's seldepth, merged into ctx for the info line.
+          std::vector<int> selDepthOf(nThreads, 0);
+
+          auto publish = [&](int sc, Move m) {
+            uint64_t cur = bestPacked.load();
+            while (sc > best_score_of(cur) && !bestPacked.compare_exchange_weak(cur, pack_best(sc, m))) {}
+          };
 
           auto worker_fn = [&](int tid) {
             Position root = pos;
@@ -1316,12 +1415,11 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
             lctx.H = &heurByThread[tid];
             lctx.allowSyzygy = (tid == 0);
             lctx.start = ctx.start;
-            lctx.hardLimitMs = ctx.hardLimitMs;
-            lctx.softLimitMs = ctx.softLimitMs;
-            lctx.nodes = 0;
+            lctx.stats = &stats[tid];
             lctx.selDepth = 0;
             lctx.rootHistoryLen = (int)root.gameKeys.size();
             lctx.keyStack[0] = root.key;
+            attach_nnue(lctx, root);
 
             while (!stopFlag.load(std::memory_order_relaxed)) {
               int i = next.fetch_add(1);
@@ -1331,24 +1429,50 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
               Undo u;
               root.make(m, u);
               lctx.keyStack[1] = root.key;
-              int sc = -negamax(root, -INF, INF, depth - 1, 1, true, m, lctx);
+              const int alpha = best_score_of(bestPacked.load());
+              const uint64_t n0 = lctx.stats->nodes.load(std::memory_order_relaxed);
+              int sc = -negamax(root, -alpha - 1, -alpha, depth - 1, 1, false, m, lctx);
+              if (sc > alpha && !stopFlag.load(std::memory_order_relaxed)) {
+                sc = -negamax(root, -INF, -alpha, depth - 1, 1, true, m, lctx);
+                movePv[i] = root_line(lctx, m);
+              }
               root.unmake(m, u);
+              tm.add_root_nodes(m, lctx.stats->nodes.load(std::memory_order_relaxed) - n0);
 
-              int cur = bestSc.load();
-              while (sc > cur && !bestSc.compare_exchange_weak(cur, sc)) {}
-              if (sc == bestSc.load()) bestMv.store((uint32_t)m);
+              // A fail-low is only an upper bound, but it never beats alpha anyway.
+              if (!stopFlag.load(std::memory_order_relaxed)) publish(sc, m);
             }
-            totalNodes.fetch_add(lctx.nodes);
+            selDepthOf[tid] = lctx.selDepth;
           };
 
-          // Thread 0 runs in this thread, others launched.
-          for (int t = 1; t < nThreads; t++) rootWorkers.emplace_back([&, t]{ worker_fn(t); });
-          worker_fn(0);
-          for (auto& th : rootWorkers) if (th.joinable()) th.join();
+          {
+            Undo u;
+            pos.make(moves[0], u);
+            ctx.keyStack[1] = pos.key;
+            const uint64_t n0 = ctx.stats->nodes.load(std::memory_order_relaxed);
+            const int sc = -negamax(pos, -INF, INF, depth - 1, 1, true, moves[0], ctx);
+            pos.unmake(moves[0], u);
+            tm.add_root_nodes(moves[0], ctx.stats->nodes.load(std::memory_order_relaxed) - n0);
+            movePv[0] = root_line(ctx, moves[0]);
+            publish(sc, moves[0]);
+          }
+
+          // Thread 0 runs in this thread, the parked helpers take the rest.
+          if (!stopFlag.load()) {
+            for (int t = 1; t < nThreads; t++) helpers.run(t - 1, [&worker_fn, t]{ worker_fn(t); });
+            worker_fn(0);
+            helpers.wait_all();
+            for (int sd : selDepthOf) ctx.selDepth = std::max(ctx.selDepth, sd);
+          }
 
-          ctx.nodes += (uint64_t)totalNodes.load();
-          score = bestSc.load();
-          ctx.stack[0].pvMove = (Move)bestMv.load();
+          const uint64_t bp = bestPacked.load();
+          score = best_score_of(bp);
+          ctx.stack[0].pvMove = (Move)(uint32_t)bp;
+          const size_t bi = std::find(moves.begin(), moves.end(), ctx.stack[0].pvMove) - moves.begin();
+          ctx.pvLen[0] = 0;
+          if (bi < moves.size()) {
+            for (Move pm : movePv[bi]) ctx.pv[0][ctx.pvLen[0]++] = pm;
+          }
         }
       }
 
@@ -1360,71 +1484,84 @@ Move Searcher::go(Position& pos, const GoLimits& lim) {
       best = ctx.stack[0].pvMove;
       if (!best) {
         TTEntry tte;
-        if (tt.probe(pos.key, tte) && tte.bestMove) best = (Move)tte.bestMove;
+        if (tt.probe(pos.key, tte)) best = pos.move_from_compact(tte.move);
       }
 
-      if (best && !is_legal(pos, best)) best = 0;
-
-      std::string pv = best ? build_pv(pos, *this, best, 32) : std::string();
-      print_info(1, bestScore, pv);
-    }
-
-    // Track PV stability across iterations (used for soft-stop)
-    if (best != 0 && best == prevIterBest && std::abs(bestScore - prevIterScore) <= 15) stableCount++;
-    else stableCount = 0;
-    prevIterBest = best;
-    prevIterScore = bestScore;
+      if (best && (!pos.is_legal(best) || !is_search_move(*this, best))) best = 0;
 
-    // Update root ordering hints: lightly decay old hints and keep the current best.
-    // This helps fixed-time stability (keeps good root moves near the top next iteration).
-    if (!rootScoreHint.empty()) {
-      for (auto& kv : rootScoreHint) kv.second = (kv.second * 3) / 4;
+      bestPv = best ? root_pv(best) : std::vector<Move>();
+      print_info(1, bestScore, pv_to_string(bestPv));
     }
-    if (best) rootScoreHint[(uint32_t)best] = bestScore;
 
-    // Current elapsed time for hard/soft checks
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - ctx.start).count();
+    // Best-move stability, score trend and root effort feed the soft limit.
+    tm.iteration_done(depth, best, bestScore);
+    if (best) timer_root_ready(true);
 
     // Decay heuristic tables occasionally (keeps them responsive across a game)
     if ((depth & 1) == 0) heurByThread[0].decay();
 
-    // Hard stop if time up
-    if (ctx.hardLimitMs > 0 && ms >= ctx.hardLimitMs) {
-      stopFlag.store(true);
-      break;
-    }
+    // Soft stop at a clean iteration boundary (single reply, easy move, or budget spent).
+    if (!pondering.load() && !lim.infinite && tm.should_stop()) break;
 
-    // Soft stop: if PV is stable, stop early (keeps bestmove coherent and avoids late aspiration blowups).
-    if (ctx.softLimitMs > 0 && ms >= ctx.softLimitMs && stableCount >= 2 && best != 0) {
-      break;
-    }
+    // go mate N: done once a mate in N moves (2N-1 plies) is proven.
+    if (lim.mate > 0 && bestScore >= MATE - (2 * lim.mate - 1)) break;
   }
 
   // Safety: verify we output a legal bestmove.
-  if (best && !is_legal(pos, best)) best = 0;
-
-  if (!best) {
-    // fall back to first legal move
-    MoveList ml; pos.gen_pseudo(ml);
-    Color us = pos.stm;
-    for (int i=0;i<ml.size;i++){
-      Move m = ml.moves[i];
+  if (best && !pos.is_legal(best)) best = 0;
+
+  if (!best) best = fallback_move(*this, pos);
+
+  // A ponder or infinite search that ran out of depth still may not answer before
+  // ponderhit / stop.
+  {
+    std::unique_lock<std::mutex> lk(ponderMutex);
+    ponderCv.wait(lk, [&] { return stopFlag.load() || (!pondering.load() && !lim.infinite); });
+    pondering.store(false);
+    searchActive = false;
+  }
+  stop_timer();
+
+  // Expected reply for the GUI to ponder on: the second PV move, else the TT move.
+  if (best) {
+    if (bestPv.size() > 1 && bestPv[0] == best) {
+      ponderMove = bestPv[1];
+    } else {
+      Position p = pos;
       Undo u;
-      pos.make(m,u);
-      bool legal = !pos.is_attacked(pos.kingSq[us], !us);
-      pos.unmake(m,u);
-      if (legal){ best = m; break; }
+      p.make(best, u);
+      TTEntry tte;
+      if (tt.probe(p.key, tte)) {
+        const Move pm = p.move_from_compact(tte.move);
+        if (pm && p.is_legal(pm)) ponderMove = pm;
+      }
     }
   }
 
-  // Stop and join helper threads (if any). Reset stopFlag for the next search.
-  if (!workers.empty()) {
-    stopFlag.store(true, std::memory_order_relaxed);
-    for (auto& th : workers) if (th.joinable()) th.join();
-    stopFlag.store(false, std::memory_order_relaxed);
-  } else {
-    // Ensure clean state
-    stopFlag.store(false, std::memory_order_relaxed);
+  // Stop and park helper threads (if any). Reset stopFlag for the next search.
+  if (lazyHelpers) {
+    {
+      std::lock_guard<std::mutex> lk(depthMutex);
+      stopFlag.store(true, std::memory_order_relaxed);
+    }
+    depthCv.notify_all();
+    helpers.wait_all();
+  }
+
+  // Whole-search summary over all threads (helpers are parked, so counts are final).
+  {
+    const SearchTotals tot = totals();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - ctx.start).count();
+    if (ms < 1) ms = 1;
+    std::cout << "info string search nodes " << tot.nodes
+              << " qnodes " << tot.qnodes
+              << " tthits " << tot.ttHits
+              << " tbhits " << tot.tbhits
+              << " threads " << nThreads
+              << " time " << ms
+              << " nps " << (tot.nodes * 1000) / (uint64_t)ms << std::endl;
   }
+  nnue::attach(pos, nullptr); // the stack dies with ctx
+  stopFlag.store(false, std::memory_order_relaxed);
   return best;
 }
\ No newline at end of file
@@ -1,23 +1,26 @@
 #pragma once
 #include <cstdint>
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include "position.h"
 #include "tt.h"
+#include "threadpool.h"
+#include "timeman.h"
 #include "polyglot_book.h"
 
-struct GoLimits {
-  int wtime_ms = 0, btime_ms = 0;
-  int winc_ms = 0, binc_ms = 0;
-  int movestogo = 0;
-  int depth = 0;       // if >0, fixed depth search
-  int movetime_ms = 0; // if >0, fixed time search
-};
-
 // Shared ply limit across the engine.
 static constexpr int SEARCH_MAX_PLY = 128;
 
+// Parallel search algorithm used when Threads > 1 (UCI option "SMPMode").
+//  - SMP_ROOT_SPLIT: shared-alpha split of the root moves (MultiPV falls back to Lazy SMP)
+//  - SMP_LAZY:       helpers re-search the previous depth to fill the TT
+//  - SMP_ABDADA:     every thread runs its own iterative deepening; at non-PV nodes a
+//                    move another thread is already searching is deferred to the end
+enum SmpMode : int { SMP_ROOT_SPLIT = 0, SMP_LAZY = 1, SMP_ABDADA = 2 };
+
 Move parse_uci_move(Position& pos, const std::string& uci);
 
 struct Searcher {
@@ -42,9 +45,57 @@ struct Searcher {
   // Threading (Lazy SMP): each thread has its own heuristics tables.
   int threads = 1;
   std::vector<Heuristics> heurByThread{1};
+  // Per-thread search counters, one cache line per thread so helpers never share a
+  // line. Only the owning thread writes its slot; UCI output sums all of them.
+  struct alignas(64) ThreadStats {
+    std::atomic<uint64_t> nodes{0};  // all nodes, qsearch included
+    std::atomic<uint64_t> qnodes{0};
+    std::atomic<uint64_t> tbhits{0};
+    std::atomic<uint64_t> ttHits{0};
+  };
+  struct SearchTotals { uint64_t nodes = 0, qnodes = 0, tbhits = 0, ttHits = 0; };
+  std::unique_ptr<ThreadStats[]> stats{std::make_unique<ThreadStats[]>(1)};
+
+  SearchTotals totals() const;
+  void clear_stats();
+
+  // Parked helper threads (threads - 1); the thread calling go() is search thread 0.
+  ThreadPool helpers;
+  SmpMode smpMode = SMP_ROOT_SPLIT;
+
+  // Hard-deadline timer: a parked thread that sleeps until the deadline (or until the
+  // search ends first) and then raises stopFlag, so search threads never read the clock.
+  // Like TimeManager::should_stop it never stops before depth 1 has a root best move.
+  ThreadPool timerThread{1};
+  std::mutex timerMutex;
+  std::condition_variable timerCv;
+  bool timerCancel = false;
+  bool timerRootReady = false;
+
+  void start_timer(std::chrono::steady_clock::time_point deadline);
+  void stop_timer();
+  void timer_root_ready(bool ready);
+
+  // Time allocation and root-move effort for the current search.
+  TimeManager tm;
+
+  // Pondering ("go ponder"): the time budget is not armed and go() holds its bestmove
+  // until ponderhit() or stop(). ponderhit() arms the deadline counted from the original
+  // go, so time spent pondering counts as thinking time for this move.
+  std::atomic<bool> pondering{false};
+  std::mutex ponderMutex;
+  std::condition_variable ponderCv;
+  bool searchActive = false; // go() has set up tm; guarded by ponderMutex
+  Move ponderMove = 0;       // expected reply to the last bestmove (from the TT PV)
+
+  void ponderhit();
 
   void set_threads(int n);
 
+  // Per-search limits from GoLimits (0 / empty = none).
+  uint64_t nodeLimit = 0;
+  std::vector<Move> searchMoves;
+
   // Options
   int maxDepth = 0;
   // Fixed-time / clock safety
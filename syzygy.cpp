@@ -95,7 +95,7 @@ bool probe_root_dtz(const Position& pos, Move& outMove, int& outWdl, int& outDtz
     return true;
   }
 
-  // Decode into our internal Move by matching pseudo-legal moves.
+  // Decode into our internal Move by matching legal moves.
   int from = (int)TB_GET_FROM(res);
   int to   = (int)TB_GET_TO(res);
   int prom = (int)TB_GET_PROMOTES(res);
@@ -108,7 +108,7 @@ bool probe_root_dtz(const Position& pos, Move& outMove, int& outWdl, int& outDtz
   else if (prom == TB_PROMOTES_KNIGHT) promoPiece = KNIGHT;
 
   MoveList ml;
-  pos.gen_pseudo(ml);
+  pos.gen_legal(ml);
   Move found = 0;
 
   for (int i=0;i<ml.size;i++) {
@@ -123,15 +123,6 @@ bool probe_root_dtz(const Position& pos, Move& outMove, int& outWdl, int& outDtz
     if (isEp && !(m_flags(m) & MF_EP)) continue;
     if (!isEp && (m_flags(m) & MF_EP)) continue;
 
-    // verify legality
-    Position tmp = pos;
-    Undo u;
-    Color us = tmp.stm;
-    tmp.make(m, u);
-    bool legal = !tmp.is_attacked(tmp.kingSq[us], !us);
-    tmp.unmake(m, u);
-    if (!legal) continue;
-
     found = m;
     break;
   }
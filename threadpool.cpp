@@ -0,0 +1,61 @@
+#include "threadpool.h"
+
+void ThreadPool::idle_loop(Worker* w) {
+  for (;;) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lk(w->m);
+      w->cv.wait(lk, [w] { return w->busy || w->quit; });
+      if (w->quit && !w->busy) return;
+      job = std::move(w->job);
+    }
+    job();
+    {
+      std::lock_guard<std::mutex> lk(w->m);
+      w->busy = false;
+    }
+    w->cv.notify_all();
+  }
+}
+
+void ThreadPool::resize(int n) {
+  if (n < 0) n = 0;
+  if (n == size()) return;
+
+  for (auto& w : workers_) {
+    {
+      std::lock_guard<std::mutex> lk(w->m);
+      w->quit = true;
+    }
+    w->cv.notify_all();
+    w->th.join();
+  }
+  workers_.clear();
+
+  for (int i = 0; i < n; i++) {
+    workers_.push_back(std::make_unique<Worker>());
+    Worker* w = workers_.back().get();
+    w->th = std::thread(idle_loop, w);
+  }
+}
+
+void ThreadPool::run(int idx, std::function<void()> job) {
+  Worker* w = workers_[(size_t)idx].get();
+  {
+    std::unique_lock<std::mutex> lk(w->m);
+    w->cv.wait(lk, [w] { return !w->busy; });
+    w->job = std::move(job);
+    w->busy = true;
+  }
+  w->cv.notify_all();
+}
+
+void ThreadPool::wait(int idx) {
+  Worker* w = workers_[(size_t)idx].get();
+  std::unique_lock<std::mutex> lk(w->m);
+  w->cv.wait(lk, [w] { return !w->busy; });
+}
+
+void ThreadPool::wait_all() {
+  for (int i = 0; i < size(); i++) wait(i);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of long-lived worker threads. Each worker sleeps on its own condition
+// variable until run() hands it a job, so idle workers cost nothing and no thread is
+// created per search / per iteration. Not thread-safe itself: one owner posts jobs.
+class ThreadPool {
+public:
+  ThreadPool() = default;
+  explicit ThreadPool(int n) { resize(n); }
+  ~ThreadPool() { resize(0); }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Joins the current workers (waiting for running jobs) and starts n new ones.
+  void resize(int n);
+  int size() const { return (int)workers_.size(); }
+
+  // Start job on worker idx (waits first if that worker is still busy).
+  void run(int idx, std::function<void()> job);
+  void wait(int idx);
+  void wait_all();
+
+private:
+  struct Worker {
+    std::thread th;
+    std::mutex m;
+    std::condition_variable cv;
+    std::function<void()> job;
+    bool busy = false;
+    bool quit = false;
+  };
+
+  static void idle_loop(Worker* w);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
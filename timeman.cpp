@@ -0,0 +1,157 @@
+#include "timeman.h"
+#include "bitboard.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Move overhead may not squeeze a budget below this (or below the budget itself, if
+// that is smaller): a 1 ms deadline leaves no time to finish even depth 1.
+static constexpr int MIN_THINK_MS = 20;
+
+// Base budget for one move from the clock (ms), 0 if there is no clock.
+static int clock_budget_ms(const Position& pos, const GoLimits& lim) {
+  int time = (pos.stm == WHITE) ? lim.wtime_ms : lim.btime_ms;
+  int inc  = (pos.stm == WHITE) ? lim.winc_ms  : lim.binc_ms;
+
+  if (time <= 0) return 0;
+
+  // Moves to go: UCI might not provide it. Use a conservative default.
+  int mtg = (lim.movestogo > 0) ? lim.movestogo : 30;
+  mtg = std::max(5, std::min(70, mtg));
+
+  // If we're in real time trouble, keep it very small.
+  if (time < 1500) {
+    int limMs = std::max(5, time / 12 + inc / 2);
+    return std::min(limMs, std::max(5, time / 3));
+  }
+
+  // Base budget: a slice of remaining time + most of the increment.
+  // Using (mtg + 6) gives more stable allocations than time/mtg.
+  double base = (double)time / (double)(mtg + 6);
+  base += 0.75 * (double)inc;
+
+  // Phase scaling: spend a bit more in the opening, a bit less in late endgames.
+  int fm = (int)pos.fullmoveNumber;
+  if (fm <= 12) base *= 1.15;
+  else if (fm >= 40) base *= 0.95;
+
+  // Endgame scaling: if very few pieces remain, avoid over-investing.
+  int pieces = popcount64(pos.occAll);
+  if (pieces <= 10) base *= 0.85;
+
+  int limit = (int)base;
+  // Never use too much of remaining time (hard safety)
+  limit = std::min(limit, time / 2);
+  // Never use too little
+  limit = std::max(limit, 5);
+  return limit;
+}
+
+void TimeManager::init(const Position& pos, const GoLimits& lim, int moveOverheadMs, Clock::time_point start) {
+  start_ = start;
+  hardMs = optimumMs = 0;
+  dynamic = false;
+  rootCount = 0;
+  lastBest = 0;
+  lastScore = lastDepth = 0;
+  stableIters = 0;
+  bestMoveChanges = 0;
+  scale = 1.0;
+  easyMove = false;
+
+  if (lim.movetime_ms > 0) {
+    // Fixed time: stop a little early (~5%, capped at 1s) only if the PV is stable.
+    hardMs = std::max(std::min(MIN_THINK_MS, lim.movetime_ms), lim.movetime_ms - moveOverheadMs);
+    int softSlack = std::min(1000, std::max(50, hardMs / 20));
+    optimumMs = std::max(1, hardMs - softSlack);
+    return;
+  }
+  if (lim.depth > 0 || lim.infinite) return;
+
+  const int base = clock_budget_ms(pos, lim);
+  if (base <= 0) return;
+
+  const int time = (pos.stm == WHITE) ? lim.wtime_ms : lim.btime_ms;
+  dynamic = true;
+  optimumMs = std::max(std::min(MIN_THINK_MS, base), base - moveOverheadMs);
+  // Unstable positions may overrun the optimum, but never by more than 3x and never
+  // past a third of the clock. In time trouble there is no room to overrun at all.
+  hardMs = (time < 1500) ? optimumMs : std::max(optimumMs, std::min(3 * base, time / 3) - moveOverheadMs);
+}
+
+void TimeManager::set_root_moves(const MoveList& ml) {
+  rootCount = ml.size;
+  for (int i = 0; i < ml.size; i++) {
+    root[i].move = ml.moves[i];
+    root[i].nodes.store(0, std::memory_order_relaxed);
+  }
+}
+
+int TimeManager::soft_ms() const {
+  if (!dynamic) return optimumMs;
+  return std::min(hardMs, std::max(1, (int)(optimumMs * scale)));
+}
+
+int64_t TimeManager::elapsed_ms() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_).count();
+}
+
+int TimeManager::find_root(Move m) const {
+  for (int i = 0; i < rootCount; i++)
+    if (root[i].move == m) return i;
+  return -1;
+}
+
+void TimeManager::add_root_nodes(Move m, uint64_t nodes) {
+  int i = find_root(m);
+  if (i >= 0) root[i].nodes.fetch_add(nodes, std::memory_order_relaxed);
+}
+
+uint64_t TimeManager::root_nodes(Move m) const {
+  int i = find_root(m);
+  return i >= 0 ? root[i].nodes.load(std::memory_order_relaxed) : 0;
+}
+
+int TimeManager::root_order_bonus(Move m) const {
+  uint64_t total = 0;
+  for (int i = 0; i < rootCount; i++) total += root[i].nodes.load(std::memory_order_relaxed);
+  if (total == 0) return 0;
+  return (int)(root_nodes(m) * 2'000'000 / total);
+}
+
+void TimeManager::iteration_done(int depth, Move best, int score) {
+  const bool changed = lastBest != 0 && best != lastBest;
+  bestMoveChanges = bestMoveChanges * 0.5 + (changed ? 1.0 : 0.0);
+
+  if (best != 0 && best == lastBest && std::abs(score - lastScore) <= 15) stableIters++;
+  else stableIters = 0;
+
+  if (dynamic && lastDepth > 0) {
+    uint64_t total = 0;
+    for (int i = 0; i < rootCount; i++) total += root[i].nodes.load(std::memory_order_relaxed);
+    const double share = total ? (double)root_nodes(best) / (double)total : 0.0;
+
+    const double instability = 1.0 + 1.2 * bestMoveChanges;
+    const double falling = std::clamp(1.0 + (lastScore - score) / 200.0, 0.8, 1.6);
+    const double effort = std::clamp(1.6 - 1.2 * share, 0.5, 1.4);
+    scale = std::clamp(instability * falling * effort, 0.3, 3.0);
+
+    // Easy move: one reply has soaked up nearly the whole tree for several iterations
+    // and the score is not sinking.
+    easyMove = depth >= 8 && share >= 0.90 && stableIters >= 4 && lastScore - score < 20;
+  }
+
+  lastBest = best;
+  lastScore = score;
+  lastDepth = depth;
+}
+
+bool TimeManager::should_stop() const {
+  if (hardMs <= 0 || lastBest == 0) return false;
+  if (rootCount == 1) return true; // only one legal move: nothing to think about
+
+  const int64_t ms = elapsed_ms();
+  if (ms >= hardMs) return true;
+  if (!dynamic) return ms >= optimumMs && stableIters >= 2;
+  if (easyMove && ms >= optimumMs / 4) return true;
+  return ms >= soft_ms();
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "position.h"
+#include "movelist.h"
+
+struct GoLimits {
+  int wtime_ms = 0, btime_ms = 0;
+  int winc_ms = 0, binc_ms = 0;
+  int movestogo = 0;
+  int depth = 0;       // if >0, fixed depth search
+  int movetime_ms = 0; // if >0, fixed time search
+  uint64_t nodes = 0;  // if >0, stop after this many nodes (all threads)
+  int mate = 0;        // if >0, stop once a mate in this many moves is found
+  bool infinite = false;         // search until "stop", ignoring the clock
+  std::vector<Move> searchmoves; // if non-empty, only these root moves are searched
+};
+
+// Per-move time allocation.
+//
+// init() computes an optimum and a maximum (hard) budget from the clock. After every
+// completed iteration the searcher reports the best move and score; the soft limit is
+// then the optimum scaled by
+//  - best-move instability (decaying count of best-move changes),
+//  - a falling score between iterations,
+//  - the share of root nodes spent on the best move (high share = easy position).
+// The hard limit is never exceeded (the searcher's timer thread enforces it).
+class TimeManager {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void init(const Position& pos, const GoLimits& lim, int moveOverheadMs, Clock::time_point start);
+  void set_root_moves(const MoveList& ml);
+
+  Clock::time_point start_time() const { return start_; }
+  // 0 = no time control (depth / infinite search).
+  int hard_ms() const { return hardMs; }
+  int optimum_ms() const { return optimumMs; }
+  int soft_ms() const;
+  int64_t elapsed_ms() const;
+
+  // Root effort: nodes spent below each root move, summed over the whole search.
+  // Each root move is searched by one thread at a time, so relaxed adds are enough.
+  void add_root_nodes(Move m, uint64_t nodes);
+  uint64_t root_nodes(Move m) const;
+  // Ordering bonus for a root move from the effort it took so far (0 .. 2'000'000).
+  int root_order_bonus(Move m) const;
+
+  // Report a completed iteration, then ask whether to stop before the next one.
+  void iteration_done(int depth, Move best, int score);
+  bool should_stop() const;
+
+private:
+  struct RootEffort {
+    Move move = 0;
+    std::atomic<uint64_t> nodes{0};
+  };
+
+  int find_root(Move m) const;
+
+  Clock::time_point start_;
+  int hardMs = 0;
+  int optimumMs = 0;
+  bool dynamic = false; // clock search: scale the soft limit (movetime keeps it fixed)
+
+  RootEffort root[256];
+  int rootCount = 0;
+
+  Move lastBest = 0;
+  int lastScore = 0;
+  int lastDepth = 0;
+  int stableIters = 0;       // iterations in a row with the same best move
+  double bestMoveChanges = 0; // decays by half every iteration
+  double scale = 1.0;         // applied to optimumMs
+  bool easyMove = false;
+};
@@ -1,143 +1,156 @@
 #include "tt.h"
 #include "types.h"
 
-// bestMove uses only 29 bits in this engine (see move.h layout), so we can store
-// TT flag in bits 29..30 without losing information.
-static inline uint32_t pack_move_and_flag(uint32_t bestMove, uint8_t flag) {
-  return (bestMove & 0x1FFFFFFFu) | ((uint32_t)(flag & 0x3u) << 29);
+#if defined(_MSC_VER) && defined(_M_X64)
+  #include <intrin.h>
+#endif
+
+// Cluster for a key: high 64 bits of key * clusterCount, which maps the key uniformly
+// onto [0, clusterCount) without a division. key16 takes the low bits, so the two
+// stay independent.
+static inline size_t cluster_index(uint64_t key, size_t n) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  return (size_t)__umulh(key, (uint64_t)n);
+#elif defined(__SIZEOF_INT128__)
+  return (size_t)(((unsigned __int128)key * (uint64_t)n) >> 64);
+#else
+  const uint64_t aL = (uint32_t)key, aH = key >> 32;
+  const uint64_t bL = (uint32_t)n, bH = (uint64_t)n >> 32;
+  const uint64_t c1 = (aL * bL) >> 32;
+  const uint64_t c2 = aH * bL + c1;
+  const uint64_t c3 = aL * bH + (uint32_t)c2;
+  return (size_t)(aH * bH + (c2 >> 32) + (c3 >> 32));
+#endif
 }
 
-static inline void unpack_move_and_flag(uint32_t packed, uint32_t& bestMove, uint8_t& flag) {
-  bestMove = packed & 0x1FFFFFFFu;
-  flag = (uint8_t)((packed >> 29) & 0x3u);
+static inline void unpack_entry(const TTEntryPacked& e, uint8_t depth8, TTEntry& out) {
+  const uint8_t gb = e.genBound8.load(std::memory_order_relaxed);
+  out.move  = e.move16.load(std::memory_order_relaxed);
+  out.score = (int16_t)e.score16.load(std::memory_order_relaxed);
+  out.eval  = (int16_t)e.eval16.load(std::memory_order_relaxed);
+  out.depth = (int8_t)(depth8 - TT_DEPTH_OFFSET);
+  out.flag  = (uint8_t)(gb & 0x3u);
+  out.gen   = (uint8_t)(gb >> 2);
 }
 
-static inline uint64_t pack_data(uint32_t bestMove, int score, int depth, uint8_t flag, uint8_t gen) {
-  uint32_t lo = pack_move_and_flag(bestMove, flag);
-  uint16_t sc = (uint16_t)(int16_t)score;
-  uint8_t d = (uint8_t)(int8_t)depth;
-  uint64_t hi = (uint64_t)sc | ((uint64_t)d << 16) | ((uint64_t)gen << 24);
-  return (uint64_t)lo | (hi << 32);
-}
-
-static inline void unpack_data(uint64_t data, TTEntry& out) {
-  uint32_t lo = (uint32_t)(data & 0xFFFFFFFFu);
-  uint32_t bm; uint8_t fl;
-  unpack_move_and_flag(lo, bm, fl);
-  out.bestMove = bm;
-  out.flag = fl;
-
-  uint32_t hi = (uint32_t)(data >> 32);
-  out.score = (int16_t)(hi & 0xFFFFu);
-  out.depth = (int8_t)((hi >> 16) & 0xFFu);
-  out.gen   = (uint8_t)((hi >> 24) & 0xFFu);
+static inline void write_entry(TTEntryPacked& e, uint64_t key, uint16_t move, int score, int eval,
+                               int depth, uint8_t flag, uint8_t gen) {
+  e.move16.store(move, std::memory_order_relaxed);
+  e.score16.store((uint16_t)(int16_t)score, std::memory_order_relaxed);
+  e.eval16.store((uint16_t)(int16_t)eval, std::memory_order_relaxed);
+  e.depth8.store((uint8_t)(depth + TT_DEPTH_OFFSET), std::memory_order_relaxed);
+  e.genBound8.store((uint8_t)((gen << 2) | (flag & 0x3u)), std::memory_order_relaxed);
+  e.key16.store((uint16_t)key, std::memory_order_release);
 }
 
 void TT::resize_mb(int mb) {
   size_t bytes = (size_t)mb * 1024ULL * 1024ULL;
-  size_t n = bytes / sizeof(TTBucket);
+  size_t n = bytes / sizeof(TTCluster);
   if (n < 1) n = 1;
-  t.clear();
-  t.resize(n);
+  if (n == clusterCount && pendingClusters == 0) return;
+  t.reset(); // release the old table now
+  clusterCount = 0;
+  pendingClusters = n;
+}
+
+void TT::allocate() {
+  if (pendingClusters == 0) return;
+  t.reset(new TTCluster[pendingClusters]());
+  clusterCount = pendingClusters;
+  pendingClusters = 0;
+  gen = 0;
 }
 
 void TT::clear() {
-  if (!t.empty()) {
-    for (auto& b : t) {
-      for (auto& e : b.e) {
-        e.key.store(0, std::memory_order_relaxed);
-        e.data.store(0, std::memory_order_relaxed);
-      }
+  for (size_t i = 0; i < clusterCount; i++) {
+    for (auto& e : t[i].e) {
+      e.key16.store(0, std::memory_order_relaxed);
+      e.move16.store(0, std::memory_order_relaxed);
+      e.score16.store(0, std::memory_order_relaxed);
+      e.eval16.store(0, std::memory_order_relaxed);
+      e.depth8.store(0, std::memory_order_relaxed);
+      e.genBound8.store(0, std::memory_order_relaxed);
     }
   }
-  gen = 1;
+  gen = 0;
 }
 
 bool TT::probe(uint64_t key, TTEntry& out) const {
-  if (t.empty()) return false;
-  const TTBucket& b = t[key % t.size()];
-  for (const auto& e : b.e) {
-    uint64_t k = e.key.load(std::memory_order_acquire);
-    if (k == key) {
-      out.key = key;
-      unpack_data(e.data.load(std::memory_order_relaxed), out);
-      return true;
-    }
+  if (clusterCount == 0) return false;
+  const TTCluster& c = t[cluster_index(key, clusterCount)];
+  const uint16_t k16 = (uint16_t)key;
+  for (const auto& e : c.e) {
+    if (e.key16.load(std::memory_order_acquire) != k16) continue;
+    const uint8_t d8 = e.depth8.load(std::memory_order_relaxed);
+    if (d8 == 0) continue;
+    out.key = key;
+    unpack_entry(e, d8, out);
+    return true;
   }
   return false;
 }
 
 int TT::hashfull() const {
-  if (t.empty()) return 0;
-  // Sample first N buckets (UCI expects a quick estimate)
-  const size_t buckets = std::min<size_t>(t.size(), 1000);
+  if (clusterCount == 0) return 0;
+  // Sample first N clusters (UCI expects a quick estimate)
+  const size_t clusters = std::min<size_t>(clusterCount, 1000);
   int filled = 0;
-  for (size_t i = 0; i < buckets; i++) {
+  for (size_t i = 0; i < clusters; i++) {
     for (const auto& e : t[i].e) {
-      uint64_t k = e.key.load(std::memory_order_relaxed);
-      if (!k) continue;
-      TTEntry tmp;
-      tmp.key = k;
-      unpack_data(e.data.load(std::memory_order_relaxed), tmp);
-      if (tmp.gen == gen) filled++;
+      if (e.depth8.load(std::memory_order_relaxed) == 0) continue;
+      if ((e.genBound8.load(std::memory_order_relaxed) >> 2) == gen) filled++;
     }
   }
-  const int total = int(buckets * 4);
+  const int total = int(clusters * TT_CLUSTER_SIZE);
   return total ? (filled * 1000) / total : 0;
 }
 
 static inline int age(uint8_t now, uint8_t then) {
-  return (int)((uint8_t)(now - then)); // wrap-safe
+  return (int)((now - then) & 63); // wrap-safe (6-bit generations)
 }
 
-void TT::store(uint64_t key, int depth, int score, uint8_t flag, uint32_t bestMove) {
-  if (t.empty()) return;
-  TTBucket& b = t[key % t.size()];
-
-  // Pre-pack once.
-  const uint64_t newData = pack_data(bestMove, score, depth, flag, gen);
+void TT::store(uint64_t key, int depth, int score, uint8_t flag, Move bestMove, int eval) {
+  if (clusterCount == 0) return;
+  TTCluster& c = t[cluster_index(key, clusterCount)];
+  const uint16_t k16 = (uint16_t)key;
+  const uint16_t move = compact_move(bestMove);
 
   // If key exists, replace if deeper or if improving bound quality
-  for (auto& e : b.e) {
-    uint64_t k = e.key.load(std::memory_order_acquire);
-    if (k == key) {
-      TTEntry cur;
-      cur.key = k;
-      unpack_data(e.data.load(std::memory_order_relaxed), cur);
-
-      // Replace if deeper, exact, or entry is from older generation.
-      if (depth > cur.depth || flag == TT_EXACT || cur.gen != gen) {
-        e.data.store(newData, std::memory_order_relaxed);
-        e.key.store(key, std::memory_order_release);
-      } else if (bestMove && !cur.bestMove) {
-        // Keep existing score/depth but add a best move if missing.
-        uint64_t patched = pack_data(bestMove, cur.score, cur.depth, cur.flag, cur.gen);
-        e.data.store(patched, std::memory_order_relaxed);
-        e.key.store(key, std::memory_order_release);
-      }
-      return;
+  for (auto& e : c.e) {
+    if (e.key16.load(std::memory_order_acquire) != k16) continue;
+    const uint8_t d8 = e.depth8.load(std::memory_order_relaxed);
+    if (d8 == 0) continue;
+    TTEntry cur;
+    unpack_entry(e, d8, cur);
+    // The eval belongs to the position, so keep a known one when this store has none.
+    const int ev = (eval != TT_EVAL_NONE) ? eval : cur.eval;
+
+    // Replace if deeper, exact, or entry is from older generation.
+    if (depth > cur.depth || flag == TT_EXACT || cur.gen != gen) {
+      write_entry(e, key, move, score, ev, depth, flag, gen);
+    } else if (move && !cur.move) {
+      // Keep existing score/depth but add a best move if missing.
+      write_entry(e, key, move, cur.score, ev, cur.depth, cur.flag, cur.gen);
     }
+    return;
   }
 
   // Choose a victim: empty first, otherwise "worst" by depth/age/bound
   int victim = 0;
   int bestScore = 1e9;
-  for (int i=0;i<4;i++) {
-    const auto& e = b.e[i];
-    uint64_t k = e.key.load(std::memory_order_relaxed);
-    if (k == 0) { victim = i; bestScore = -1e9; break; }
+  for (int i = 0; i < TT_CLUSTER_SIZE; i++) {
+    const auto& e = c.e[i];
+    const uint8_t d8 = e.depth8.load(std::memory_order_relaxed);
+    if (d8 == 0) { victim = i; break; }
     TTEntry cur;
-    cur.key = k;
-    unpack_data(e.data.load(std::memory_order_relaxed), cur);
+    unpack_entry(e, d8, cur);
     int a = age(gen, cur.gen);
     int s = (int)cur.depth - 2*a;
     if (cur.flag != TT_EXACT) s -= 1; // exact entries slightly protected
     if (s < bestScore) { bestScore = s; victim = i; }
   }
 
-  auto& e = b.e[victim];
-  e.data.store(newData, std::memory_order_relaxed);
-  e.key.store(key, std::memory_order_release);
+  write_entry(c.e[victim], key, move, score, eval, depth, flag, gen);
 }
 
 static constexpr int MATE = SCORE_INF;
@@ -1,72 +1,75 @@
 #pragma once
 #include <cstdint>
-#include <vector>
-#include <array>
 #include <cstring>
 #include <atomic>
+#include <memory>
+#include "move.h"
 
 enum : uint8_t { TT_ALPHA=0, TT_BETA=1, TT_EXACT=2 };
 
+// Depth of quiescence entries: below every main-search entry (depth >= 1), with the
+// quiet-check ply ranked above plain capture search.
+static constexpr int TT_DEPTH_QS_CHECKS = 0;
+static constexpr int TT_DEPTH_QS = -1;
+static constexpr int TT_DEPTH_OFFSET = 2; // stored depth8 of TT_DEPTH_QS is 1
+
+// Static eval slot value when none was computed (side to move in check).
+static constexpr int TT_EVAL_NONE = -32768;
+
 struct TTEntry {
   uint64_t key = 0;
-  uint32_t bestMove = 0;
+  uint16_t move = 0;  // compact move (see compact_move), 0 = none
   int16_t score = 0;
+  int16_t eval = TT_EVAL_NONE; // static eval of the position (not a search score)
   int8_t depth = 0;
   uint8_t flag = TT_ALPHA;
-  uint8_t gen = 0;   // generation (ageing)
-  uint8_t _pad = 0;  // keep alignment simple
+  uint8_t gen = 0;    // generation (ageing), 6 bits
 };
 
-// Thread-safe packed TT entry.
-// We avoid UB data races by only touching atomics.
+// Stored TT entry: 10 bytes, six to a 64-byte cluster.
+// We avoid UB data races by only touching atomics; key16 is written last (release) and
+// read first (acquire). A torn entry can only mix fields of two stores, and the search
+// validates TT moves before playing them.
 //
-// Layout of packed 'data' (64-bit):
-//  - low  32 bits: bestMove with TT flag stored in bits 29..30 (move uses only 29 bits)
-//  - high 32 bits: score (16), depth (8), gen (8)
+//  - key16:     low 16 bits of the Zobrist key (the cluster index uses the high bits)
+//  - depth8:    depth + TT_DEPTH_OFFSET, 0 = empty slot
+//  - genBound8: generation (6 bits) << 2 | flag (2 bits)
 struct TTEntryPacked {
-  std::atomic<uint64_t> key{0};
-  std::atomic<uint64_t> data{0};
-
-  TTEntryPacked() = default;
-
-  // std::atomic is not copyable by default. We make TT entries movable/copyable
-  // by copying the contained values, which is fine for a transposition table.
-  TTEntryPacked(const TTEntryPacked& o)
-      : key(o.key.load(std::memory_order_relaxed)),
-        data(o.data.load(std::memory_order_relaxed)) {}
-
-  TTEntryPacked& operator=(const TTEntryPacked& o) {
-    key.store(o.key.load(std::memory_order_relaxed), std::memory_order_relaxed);
-    data.store(o.data.load(std::memory_order_relaxed), std::memory_order_relaxed);
-    return *this;
-  }
-
-  TTEntryPacked(TTEntryPacked&& o) noexcept : TTEntryPacked(o) {}
-  TTEntryPacked& operator=(TTEntryPacked&& o) noexcept { return (*this = o); }
+  std::atomic<uint16_t> key16{0};
+  std::atomic<uint16_t> move16{0};
+  std::atomic<uint16_t> score16{0};
+  std::atomic<uint16_t> eval16{0};
+  std::atomic<uint8_t> depth8{0};
+  std::atomic<uint8_t> genBound8{0};
 };
 
-struct TTBucket {
-  std::array<TTEntryPacked, 4> e{};
+static constexpr int TT_CLUSTER_SIZE = 6;
 
-  TTBucket() = default;
-  TTBucket(const TTBucket& o) : e(o.e) {}
-  TTBucket& operator=(const TTBucket& o) { e = o.e; return *this; }
-  TTBucket(TTBucket&& o) noexcept : TTBucket(o) {}
-  TTBucket& operator=(TTBucket&& o) noexcept { return (*this = o); }
+struct alignas(64) TTCluster {
+  TTEntryPacked e[TT_CLUSTER_SIZE];
+  char _pad[64 - TT_CLUSTER_SIZE * sizeof(TTEntryPacked)];
 };
 
+static_assert(sizeof(TTEntryPacked) == 10, "TT entry must stay 10 bytes");
+static_assert(sizeof(TTCluster) == 64, "TT cluster must fill one cache line");
+
 struct TT {
-  std::vector<TTBucket> t;
-  uint8_t gen = 1;
+  std::unique_ptr<TTCluster[]> t;
+  size_t clusterCount = 0;
+  uint8_t gen = 0;
+  size_t pendingClusters = 0; // requested size not yet allocated (see allocate())
 
+  // resize_mb only records the size; the table is allocated on the first allocate()
+  // (isready / search start), so setting Hash or starting the engine is cheap.
   void resize_mb(int mb);
+  void allocate();
   void clear();
 
   // Call once per new root search to age entries (no need to clear)
-  inline void new_search() { gen = uint8_t(gen + 1); if (gen == 0) gen = 1; }
+  inline void new_search() { gen = uint8_t((gen + 1) & 63); }
 
   bool probe(uint64_t key, TTEntry& out) const;
-  void store(uint64_t key, int depth, int score, uint8_t flag, uint32_t bestMove);
+  void store(uint64_t key, int depth, int score, uint8_t flag, Move bestMove, int eval);
 
   // UCI: hashfull in permill (0..1000)
   int hashfull() const;
@@ -1,7 +1,10 @@
 #include "uci.h"
 #include "fen.h"
 #include "search.h"
+#include "eval.h"
+#include "nnue.h"
 #include "params.h"
+#include "perft.h"
 #include <iostream>
 #include <sstream>
 #include <thread>
@@ -75,17 +78,19 @@ static bool parse_position_cmd(Position& pos, const std::string& line) {
 void uci_loop(Position& pos) {
   auto searcher = std::make_unique<Searcher>();
   searcher->tt_resize_mb(64); // safe default; change later
+  int hashMb = 64;            // also sizes the perft hash for go perft / divide
 
   std::atomic<bool> searching{false};
-  std::thread searchThread;
+  // One persistent thread drives every "go" (parked between searches).
+  ThreadPool searchThread(1);
 
   auto join_if_needed = [&](){
-    if (searchThread.joinable()) searchThread.join();
+    searchThread.wait(0);
   };
 
 auto stop_search = [&](){
   searcher->stop();        // safe even if not searching
-  join_if_needed();       // ALWAYS join if joinable
+  join_if_needed();       // wait until the search thread is parked again
   searching.store(false);
 };
 
@@ -95,8 +100,13 @@ auto stop_search = [&](){
       std::cout << "id name Chessy\n";
       std::cout << "id author prani\n";
       std::cout << "option name Hash type spin default 64 min 1 max 2048\n";
+      std::cout << "option name EvalCache type spin default " << EVAL_CACHE_DEFAULT_MB << " min 1 max 1024\n";
+      std::cout << "option name PawnCache type spin default " << PAWN_CACHE_DEFAULT_MB << " min 1 max 256\n";
+      std::cout << "option name EvalFile type string default \n";
       std::cout << "option name Threads type spin default 1 min 1 max 64\n";
+      std::cout << "option name SMPMode type combo default RootSplit var RootSplit var LazySMP var ABDADA\n";
       std::cout << "option name MoveOverhead type spin default 50 min 0 max 500\n";
+      std::cout << "option name Ponder type check default false\n";
       std::cout << "option name UseSyzygy type check default true\n";
       std::cout << "option name SyzygyPath type string default \n";
       std::cout << "option name OwnBook type check default true\n";
@@ -109,6 +119,7 @@ auto stop_search = [&](){
       std::cout << "uciok\n";
       std::cout.flush();
     } else if (line == "isready") {
+      if (!searching.load()) searcher->tt.allocate(); // deferred Hash allocation
       std::cout << "readyok\n";
       std::cout.flush();
         } else if (line.rfind("setoption", 0) == 0) {
@@ -129,11 +140,42 @@ auto stop_search = [&](){
       while (!value.empty() && value[0] == ' ') value.erase(value.begin());
 
 if (name == "Hash") {
+  stop_search(); // resizing frees the table the searchers are probing
   try {
     int mb = std::stoi(value);
     mb = std::max(1, std::min(2048, mb));
     searcher->tt_resize_mb(mb);
+    hashMb = mb;
   } catch (...) {}
+} else if (name == "EvalCache") {
+  stop_search();
+  try {
+    int mb = std::stoi(value);
+    mb = std::max(1, std::min(1024, mb));
+    eval_cache_resize_mb(mb);
+  } catch (...) {}
+} else if (name == "PawnCache") {
+  stop_search();
+  try {
+    int mb = std::stoi(value);
+    mb = std::max(1, std::min(256, mb));
+    pawn_cache_resize_mb(mb);
+  } catch (...) {}
+} else if (name == "EvalFile") {
+  // Empty = classical eval. A file that fails to load keeps the current evaluator.
+  stop_search(); // never swap the network under a running search
+  if (value.empty()) {
+    nnue::unload();
+    std::cout << "info string NNUE disabled, using classical eval" << std::endl;
+  } else if (nnue::load(value)) {
+    std::cout << "info string NNUE loaded " << value << " simd "
+              << nnue::simd_backend_name(nnue::simd_backend()) << std::endl;
+  } else {
+    std::cout << "info string NNUE failed to load " << value << std::endl;
+  }
+  // Cached and TT static evals (and TT scores) belong to the previous evaluator.
+  eval_cache_clear();
+  searcher->clear();
 } else if (name == "MoveOverhead") {
   try {
     int ms = std::stoi(value);
@@ -141,13 +183,20 @@ if (name == "Hash") {
     searcher->moveOverheadMs = ms;
   } catch (...) {}
 } else if (name == "SyzygyPath") {
+  stop_search(); // tables are unmapped and reloaded
   searcher->set_syzygy_path(value);
 } else if (name == "Threads") {
+  stop_search(); // rebuilds the helper pool, per-thread stats and heuristics
   try {
     int n = std::stoi(value);
     n = std::max(1, std::min(64, n));
     searcher->set_threads(n);
   } catch (...) {}
+} else if (name == "SMPMode") {
+  stop_search();
+  if (value == "LazySMP") searcher->smpMode = SMP_LAZY;
+  else if (value == "ABDADA") searcher->smpMode = SMP_ABDADA;
+  else searcher->smpMode = SMP_ROOT_SPLIT;
 } else if (name == "UseSyzygy") {
   if (value == "false" || value == "0") searcher->useSyzygy = false;
   else searcher->useSyzygy = true;
@@ -203,8 +252,22 @@ if (name == "Hash") {
       std::istringstream iss(line);
       std::string tok;
       iss >> tok; // go
+      int perftDepth = 0;
+      bool ponder = false;
+      bool inSearchMoves = false;
       while (iss >> tok) {
-        if (tok == "wtime") iss >> lim.wtime_ms;
+        // searchmoves takes every following token that parses as a move
+        if (inSearchMoves) {
+          if (Move m = parse_uci_move(pos, tok)) { lim.searchmoves.push_back(m); continue; }
+          inSearchMoves = false;
+        }
+        if (tok == "perft") { iss >> perftDepth; break; }
+        if (tok == "searchmoves") inSearchMoves = true;
+        else if (tok == "infinite") lim.infinite = true;
+        else if (tok == "nodes") iss >> lim.nodes;
+        else if (tok == "mate") iss >> lim.mate;
+        else if (tok == "ponder") ponder = true;
+        else if (tok == "wtime") iss >> lim.wtime_ms;
         else if (tok == "btime") iss >> lim.btime_ms;
         else if (tok == "winc") iss >> lim.winc_ms;
         else if (tok == "binc") iss >> lim.binc_ms;
@@ -214,10 +277,16 @@ if (name == "Hash") {
         
       }
 
+      // "go perft N": synchronous divide, no bestmove.
+      if (perftDepth > 0) {
+        perft_divide(pos, perftDepth, searcher->threads, hashMb, std::cout);
+        continue;
+      }
+
       // Opening book (Polyglot) at root: return immediately if found.
       // Determine current game ply from FEN counters.
       int gamePly = (int)(pos.fullmoveNumber - 1) * 2 + (pos.stm == BLACK ? 1 : 0);
-      if (searcher->useBook && searcher->book.loaded() && gamePly < searcher->bookMaxPly) {
+      if (!ponder && !lim.infinite && lim.searchmoves.empty() && searcher->useBook && searcher->book.loaded() && gamePly < searcher->bookMaxPly) {
         Position tmp = pos;
         Move bm = searcher->probe_book(tmp);
         if (bm) {
@@ -233,16 +302,40 @@ if (name == "Hash") {
       }
 
       // launch async search so "stop" works
+      // Set before the thread starts so an early ponderhit is never lost.
       searching.store(true);
+      searcher->pondering.store(ponder);
       Position rootCopy = pos;
-      searchThread = std::thread([&, rootCopy, lim]() mutable {
+      searchThread.run(0, [&, rootCopy, lim]() mutable {
         Move best = searcher->go(rootCopy, lim);
-        if (best) std::cout << "bestmove " << move_to_uci(best) << "\n";
+        if (best) {
+          std::cout << "bestmove " << move_to_uci(best);
+          if (searcher->ponderMove) std::cout << " ponder " << move_to_uci(searcher->ponderMove);
+          std::cout << "\n";
+        }
         else std::cout << "bestmove 0000\n";
         std::cout.flush();
         searching.store(false);
       });
 
+    } else if (line.rfind("divide", 0) == 0) {
+      stop_search();
+      std::istringstream iss(line);
+      std::string tok;
+      int depth = 0;
+      iss >> tok >> depth;
+      if (depth > 0) perft_divide(pos, depth, searcher->threads, hashMb, std::cout);
+    } else if (line.rfind("perftsuite", 0) == 0) {
+      // perftsuite <file.epd> [maxDepth] [hashMb] (unhashed by default: timing movegen)
+      stop_search();
+      std::istringstream iss(line);
+      std::string tok, file;
+      int maxDepth = 6, suiteHashMb = 0;
+      iss >> tok >> file >> maxDepth >> suiteHashMb;
+      perft_suite(file, maxDepth, searcher->threads, suiteHashMb, std::cout);
+    } else if (line == "ponderhit") {
+      // The opponent played the expected move: keep searching on the normal budget.
+      searcher->ponderhit();
     } else if (line == "stop") {
       stop_search();
     } else if (line == "quit") {
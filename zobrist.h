@@ -1,9 +1,39 @@
 #pragma once
 #include <cstdint>
 
-extern uint64_t ZP[12][64];
-extern uint64_t ZSide;
-extern uint64_t ZCastle[16];
-extern uint64_t ZEP[9];
+// Zobrist keys are generated at compile time (splitmix64, fixed seed), so they live in
+// read-only data and need no startup initialisation. Key values are unchanged from the
+// old runtime generator, so saved hashes and debug logs still match.
+struct ZobristKeys {
+  uint64_t piece[12][64]{};
+  uint64_t side = 0;
+  uint64_t castle[16]{};
+  uint64_t ep[9]{};
+};
 
-void zobrist_init();
+constexpr uint64_t zobrist_splitmix64(uint64_t& x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys make_zobrist_keys() {
+  ZobristKeys k{};
+  uint64_t seed = 123456789ULL;
+  for (int pc=0; pc<12; pc++)
+    for (int sq=0; sq<64; sq++)
+      k.piece[pc][sq] = zobrist_splitmix64(seed);
+
+  k.side = zobrist_splitmix64(seed);
+  for (int i=0;i<16;i++) k.castle[i] = zobrist_splitmix64(seed);
+  for (int i=0;i<9;i++)  k.ep[i] = zobrist_splitmix64(seed);
+  return k;
+}
+
+inline constexpr ZobristKeys ZOBRIST = make_zobrist_keys();
+
+inline constexpr const uint64_t (&ZP)[12][64] = ZOBRIST.piece;
+inline constexpr uint64_t ZSide = ZOBRIST.side;
+inline constexpr const uint64_t (&ZCastle)[16] = ZOBRIST.castle;
+inline constexpr const uint64_t (&ZEP)[9] = ZOBRIST.ep;